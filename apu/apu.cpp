@@ -30,35 +30,36 @@ static const int MINIMUM_BUFFER_SIZE = 550 * 2;
 
 namespace SNES {
 #include "bapu/dsp/blargg_endian.h"
-CPU cpu;
+S9X_TLS CPU cpu;
 } // namespace SNES
 
 namespace spc {
-static apu_callback callback = NULL;
-static void *callback_data = NULL;
+static S9X_TLS apu_callback callback = NULL;
+static S9X_TLS void *callback_data = NULL;
 
-static bool8 sound_in_sync = true;
-static bool8 sound_enabled = false;
+static S9X_TLS bool8 sound_in_sync = true;
+static S9X_TLS bool8 sound_enabled = false;
+static S9X_TLS bool8 discard_samples = false;
 
-static Resampler resampler;
+static S9X_TLS Resampler resampler;
 
-static int32 reference_time;
-static uint32 remainder;
+static S9X_TLS int32 reference_time;
+static S9X_TLS uint32 remainder;
 
 static const int timing_hack_numerator = 256;
-static int timing_hack_denominator = 256;
+static S9X_TLS int timing_hack_denominator = 256;
 /* Set these to NTSC for now. Will change to PAL in S9xAPUTimingSetSpeedup
    if necessary on game load. */
-static uint32 ratio_numerator = APU_NUMERATOR_NTSC;
-static uint32 ratio_denominator = APU_DENOMINATOR_NTSC;
+static S9X_TLS uint32 ratio_numerator = APU_NUMERATOR_NTSC;
+static S9X_TLS uint32 ratio_denominator = APU_DENOMINATOR_NTSC;
 
-static double dynamic_rate_multiplier = 1.0;
+static S9X_TLS double dynamic_rate_multiplier = 1.0;
 } // namespace spc
 
 namespace msu {
 // Always 16-bit, Stereo; 1.5x dsp buffer to never overflow
-static Resampler resampler;
-static std::vector<int16_t> resampler_buffer;
+static S9X_TLS Resampler resampler;
+static S9X_TLS std::vector<int16_t> resampler_buffer;
 } // namespace msu
 
 static void UpdatePlaybackRate(void);
@@ -135,6 +136,14 @@ void S9xClearSamples(void)
         msu::resampler.clear();
 }
 
+// For frames nobody will hear, like the ones run ahead: their samples never reach the frontend
+void S9xDiscardSamples(bool8 discard)
+{
+    spc::discard_samples = discard;
+    if (!discard)
+        S9xClearSamples();
+}
+
 bool8 S9xSyncSound(void)
 {
     if (!Settings.SoundSync || spc::sound_in_sync)
@@ -284,7 +293,12 @@ void S9xAPUEndScanline(void)
     SNES::dsp.synchronize();
 
     if (spc::resampler.space_filled() >= APU_SAMPLE_BLOCK)
-        S9xLandSamples();
+    {
+        if (spc::discard_samples)
+            S9xClearSamples();
+        else
+            S9xLandSamples();
+    }
 }
 
 void S9xAPUTimingSetSpeedup(int ticks)
@@ -39,6 +39,7 @@ void S9xSetSoundControl (uint8);
 void S9xSetSoundMute (bool8);
 void S9xLandSamples (void);
 void S9xClearSamples (void);
+void S9xDiscardSamples (bool8);
 bool8 S9xMixSamples (uint8 *, int);
 void S9xSetSamplesAvailableCallback (apu_callback, void *);
 void S9xUpdateDynamicRate (int empty = 1, int buffer_size = 2);
@@ -3,7 +3,7 @@
 #define DSP_CPP
 namespace SNES {
 
-DSP dsp;
+S9X_TLS DSP dsp;
 
 #include "SPC_DSP.cpp"
 
@@ -13,7 +13,7 @@ namespace SNES {
 #include "debugger/disassembler.cpp"
 #endif
 
-SMP smp;
+S9X_TLS SMP smp;
 
 #include "algorithms.cpp"
 #include "core.cpp"
@@ -40,7 +40,7 @@ public:
     }
 };
 
-extern CPU cpu;
+extern S9X_TLS CPU cpu;
 
 } // namespace SNES
 
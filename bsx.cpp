@@ -20,9 +20,7 @@
 #define FLASH_SIZE	0x100000
 #define PSRAM_SIZE	0x80000
 
-#define Map			Memory.Map
-#define BlockIsRAM	Memory.BlockIsRAM
-#define BlockIsROM	Memory.BlockIsROM
+#define Block		Memory.Block
 #define RAM			Memory.RAM
 #define SRAM		Memory.SRAM
 #define PSRAM		Memory.BSRAM
@@ -30,6 +28,9 @@
 #define MAP_BSX		Memory.MAP_BSX
 #define MAP_CPU		Memory.MAP_CPU
 #define MAP_PPU		Memory.MAP_PPU
+#ifdef USE_REX
+#define MAP_REX_2C00	Memory.MAP_REX_2C00
+#endif
 #define MAP_NONE	Memory.MAP_NONE
 
 #define BSXPPUBASE	0x2180
@@ -46,7 +47,7 @@ struct SBSX_RTC
 	int	ticks;
 };
 
-static struct SBSX_RTC	BSX_RTC;
+static S9X_TLS struct SBSX_RTC	BSX_RTC;
 
 // flash card vendor information
 static const uint8	flashcard[20] =
@@ -72,9 +73,9 @@ static const uint8	init2192[32] =	// FIXME
 };
 #endif
 
-static bool8	FlashMode;
-static uint32	FlashSize;
-static uint8	*MapROM, *FlashROM;
+static S9X_TLS bool8	FlashMode;
+static S9X_TLS uint32	FlashSize;
+static S9X_TLS uint8	*MapROM, *FlashROM;
 
 static void BSX_Map_SNES (void);
 static void BSX_Map_LoROM (void);
@@ -100,17 +101,21 @@ static void BSX_Map_SNES (void)
 	// Banks 00->3F and 80->BF
 	for (c = 0; c < 0x400; c += 16)
 	{
-		Map[c + 0] = Map[c + 0x800] = RAM;
-		Map[c + 1] = Map[c + 0x801] = RAM;
-		BlockIsRAM[c + 0] = BlockIsRAM[c + 0x800] = TRUE;
-		BlockIsRAM[c + 1] = BlockIsRAM[c + 0x801] = TRUE;
-
-		Map[c + 2] = Map[c + 0x802] = (uint8 *) MAP_PPU;
-		Map[c + 3] = Map[c + 0x803] = (uint8 *) MAP_PPU;
-		Map[c + 4] = Map[c + 0x804] = (uint8 *) MAP_CPU;
-		Map[c + 5] = Map[c + 0x805] = (uint8 *) MAP_CPU;
-		Map[c + 6] = Map[c + 0x806] = (uint8 *) MAP_NONE;
-		Map[c + 7] = Map[c + 0x807] = (uint8 *) MAP_NONE;
+		Block[c + 0].Map = Block[c + 0x800].Map = RAM;
+		Block[c + 1].Map = Block[c + 0x801].Map = RAM;
+		Block[c + 0].IsRAM = Block[c + 0x800].IsRAM = TRUE;
+		Block[c + 1].IsRAM = Block[c + 0x801].IsRAM = TRUE;
+
+	#ifdef USE_REX
+		Block[c + 2].Map = Block[c + 0x802].Map = (uint8 *) MAP_REX_2C00;
+	#else
+		Block[c + 2].Map = Block[c + 0x802].Map = (uint8 *) MAP_PPU;
+	#endif
+		Block[c + 3].Map = Block[c + 0x803].Map = (uint8 *) MAP_PPU;
+		Block[c + 4].Map = Block[c + 0x804].Map = (uint8 *) MAP_CPU;
+		Block[c + 5].Map = Block[c + 0x805].Map = (uint8 *) MAP_CPU;
+		Block[c + 6].Map = Block[c + 0x806].Map = (uint8 *) MAP_NONE;
+		Block[c + 7].Map = Block[c + 0x807].Map = (uint8 *) MAP_NONE;
 	}
 }
 
@@ -125,9 +130,9 @@ static void BSX_Map_LoROM (void)
 	{
 		for (i = c + 8; i < c + 16; i++)
 		{
-			Map[i] = Map[i + 0x800] = &MapROM[(c << 11) % FlashSize] - 0x8000;
-			BlockIsRAM[i] = BlockIsRAM[i + 0x800] = BSX.write_enable;
-			BlockIsROM[i] = BlockIsROM[i + 0x800] = !BSX.write_enable;
+			Block[i].Map = Block[i + 0x800].Map = &MapROM[(c << 11) % FlashSize] - 0x8000;
+			Block[i].IsRAM = Block[i + 0x800].IsRAM = BSX.write_enable;
+			Block[i].IsROM = Block[i + 0x800].IsROM = !BSX.write_enable;
 		}
 	}
 
@@ -135,15 +140,15 @@ static void BSX_Map_LoROM (void)
 	for (c = 0; c < 0x400; c += 16)
 	{
 		for (i = c; i < c + 8; i++)
-			Map[i + 0x400] = Map[i + 0xC00] = &MapROM[(c << 11) % FlashSize];
+			Block[i + 0x400].Map = Block[i + 0xC00].Map = &MapROM[(c << 11) % FlashSize];
 
 		for (i = c + 8; i < c + 16; i++)
-			Map[i + 0x400] = Map[i + 0xC00] = &MapROM[(c << 11) % FlashSize] - 0x8000;
+			Block[i + 0x400].Map = Block[i + 0xC00].Map = &MapROM[(c << 11) % FlashSize] - 0x8000;
 
 		for (i = c; i < c + 16; i++)
 		{
-			BlockIsRAM[i + 0x400] = BlockIsRAM[i + 0xC00] = BSX.write_enable;
-			BlockIsROM[i + 0x400] = BlockIsROM[i + 0xC00] = !BSX.write_enable;
+			Block[i + 0x400].IsRAM = Block[i + 0xC00].IsRAM = BSX.write_enable;
+			Block[i + 0x400].IsROM = Block[i + 0xC00].IsROM = !BSX.write_enable;
 		}
 	}
 }
@@ -159,9 +164,9 @@ static void BSX_Map_HiROM (void)
 	{
 		for (i = c + 8; i < c + 16; i++)
 		{
-			Map[i] = Map[i + 0x800] = &MapROM[(c << 12) % FlashSize];
-			BlockIsRAM[i] = BlockIsRAM[i + 0x800] = BSX.write_enable;
-			BlockIsROM[i] = BlockIsROM[i + 0x800] = !BSX.write_enable;
+			Block[i].Map = Block[i + 0x800].Map = &MapROM[(c << 12) % FlashSize];
+			Block[i].IsRAM = Block[i + 0x800].IsRAM = BSX.write_enable;
+			Block[i].IsROM = Block[i + 0x800].IsROM = !BSX.write_enable;
 		}
 	}
 
@@ -170,9 +175,9 @@ static void BSX_Map_HiROM (void)
 	{
 		for (i = c; i < c + 16; i++)
 		{
-			Map[i + 0x400] = Map[i + 0xC00] = &MapROM[(c << 12) % FlashSize];
-			BlockIsRAM[i + 0x400] = BlockIsRAM[i + 0xC00] = BSX.write_enable;
-			BlockIsROM[i + 0x400] = BlockIsROM[i + 0xC00] = !BSX.write_enable;
+			Block[i + 0x400].Map = Block[i + 0xC00].Map = &MapROM[(c << 12) % FlashSize];
+			Block[i + 0x400].IsRAM = Block[i + 0xC00].IsRAM = BSX.write_enable;
+			Block[i + 0x400].IsROM = Block[i + 0xC00].IsROM = !BSX.write_enable;
 		}
 	}
 }
@@ -184,8 +189,8 @@ static void BSX_Map_MMC (void)
 	// Banks 01->0E:5000-5FFF
 	for (c = 0x010; c < 0x0F0; c += 16)
 	{
-		Map[c + 5] = (uint8 *) MAP_BSX;
-		BlockIsRAM[c + 5] = BlockIsROM[c + 5] = FALSE;
+		Block[c + 5].Map = (uint8 *) MAP_BSX;
+		Block[c + 5].IsRAM = Block[c + 5].IsROM = FALSE;
 	}
 }
 
@@ -200,9 +205,9 @@ static void BSX_Map_FlashIO (void)
 		{
 			for (i = c + 8; i < c + 16; i++)
 			{
-				Map[i] = Map[i + 0x800] = (uint8 *)MAP_BSX;
-				BlockIsRAM[i] = BlockIsRAM[i + 0x800] = TRUE;
-				BlockIsROM[i] = BlockIsROM[i + 0x800] = FALSE;
+				Block[i].Map = Block[i + 0x800].Map = (uint8 *)MAP_BSX;
+				Block[i].IsRAM = Block[i + 0x800].IsRAM = TRUE;
+				Block[i].IsROM = Block[i + 0x800].IsROM = FALSE;
 			}
 		}
 
@@ -211,9 +216,9 @@ static void BSX_Map_FlashIO (void)
 		{
 			for (i = c; i < c + 16; i++)
 			{
-				Map[i + 0x400] = Map[i + 0xC00] = (uint8 *)MAP_BSX;
-				BlockIsRAM[i + 0x400] = BlockIsRAM[i + 0xC00] = TRUE;
-				BlockIsROM[i + 0x400] = BlockIsROM[i + 0xC00] = FALSE;
+				Block[i + 0x400].Map = Block[i + 0xC00].Map = (uint8 *)MAP_BSX;
+				Block[i + 0x400].IsRAM = Block[i + 0xC00].IsRAM = TRUE;
+				Block[i + 0x400].IsROM = Block[i + 0xC00].IsROM = FALSE;
 			}
 		}
 	}	
@@ -226,9 +231,9 @@ static void BSX_Map_SRAM (void)
 	// Banks 10->17:5000-5FFF
 	for (c = 0x100; c < 0x180; c += 16)
 	{
-		Map[c + 5] = (uint8 *) SRAM + ((c & 0x70) << 8) - 0x5000;
-		BlockIsRAM[c + 5] = TRUE;
-		BlockIsROM[c + 5] = FALSE;
+		Block[c + 5].Map = (uint8 *) SRAM + ((c & 0x70) << 8) - 0x5000;
+		Block[c + 5].IsRAM = TRUE;
+		Block[c + 5].IsROM = FALSE;
 	}
 }
 
@@ -247,18 +252,18 @@ static void map_psram_mirror_sub (uint32 bank)
 			{
 				for (i = c; i < c + 16; i++)
 				{
-					Map[i + bank] = &PSRAM[(c << 12) % PSRAM_SIZE];
-					BlockIsRAM[i + bank] = TRUE;
-					BlockIsROM[i + bank] = FALSE;
+					Block[i + bank].Map = &PSRAM[(c << 12) % PSRAM_SIZE];
+					Block[i + bank].IsRAM = TRUE;
+					Block[i + bank].IsROM = FALSE;
 				}
 			}
 			else
 			{
 				for (i = c + 8; i < c + 16; i++)
 				{
-					Map[i + bank] = &PSRAM[(c << 12) % PSRAM_SIZE];
-					BlockIsRAM[i + bank] = TRUE;
-					BlockIsROM[i + bank] = FALSE;
+					Block[i + bank].Map = &PSRAM[(c << 12) % PSRAM_SIZE];
+					Block[i + bank].IsRAM = TRUE;
+					Block[i + bank].IsROM = FALSE;
 				}
 			}
 		}
@@ -272,17 +277,17 @@ static void map_psram_mirror_sub (uint32 bank)
 			{
 				for (i = c; i < c + 8; i++)
 				{
-					Map[i + bank] = &PSRAM[(c << 11) % PSRAM_SIZE];
-					BlockIsRAM[i + bank] = TRUE;
-					BlockIsROM[i + bank] = FALSE;
+					Block[i + bank].Map = &PSRAM[(c << 11) % PSRAM_SIZE];
+					Block[i + bank].IsRAM = TRUE;
+					Block[i + bank].IsROM = FALSE;
 				}
 			}
 
 			for (i = c + 8; i < c + 16; i++)
 			{
-				Map[i + bank] = &PSRAM[(c << 11) % PSRAM_SIZE] - 0x8000;
-				BlockIsRAM[i + bank] = TRUE;
-				BlockIsROM[i + bank] = FALSE;
+				Block[i + bank].Map = &PSRAM[(c << 11) % PSRAM_SIZE] - 0x8000;
+				Block[i + bank].IsRAM = TRUE;
+				Block[i + bank].IsROM = FALSE;
 			}
 		}
 	}
@@ -408,12 +413,12 @@ static void BSX_Map_PSRAM(void)
 			//Map PSRAM to 20->3F:6000-7FFF
 			for (c = 0x200; c < 0x400; c += 16)
 			{
-				Map[c + 6] = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
-				Map[c + 7] = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
-				BlockIsRAM[c + 6] = TRUE;
-				BlockIsRAM[c + 7] = TRUE;
-				BlockIsROM[c + 6] = FALSE;
-				BlockIsROM[c + 7] = FALSE;
+				Block[c + 6].Map = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
+				Block[c + 7].Map = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
+				Block[c + 6].IsRAM = TRUE;
+				Block[c + 7].IsRAM = TRUE;
+				Block[c + 6].IsROM = FALSE;
+				Block[c + 7].IsROM = FALSE;
 			}
 		}
 
@@ -422,12 +427,12 @@ static void BSX_Map_PSRAM(void)
 			//Map PSRAM to A0->BF:6000-7FFF
 			for (c = 0xA00; c < 0xC00; c += 16)
 			{
-				Map[c + 6] = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
-				Map[c + 7] = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
-				BlockIsRAM[c + 6] = TRUE;
-				BlockIsRAM[c + 7] = TRUE;
-				BlockIsROM[c + 6] = FALSE;
-				BlockIsROM[c + 7] = FALSE;
+				Block[c + 6].Map = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
+				Block[c + 7].Map = &PSRAM[((c & 0x70) << 12) % PSRAM_SIZE];
+				Block[c + 6].IsRAM = TRUE;
+				Block[c + 7].IsRAM = TRUE;
+				Block[c + 6].IsROM = FALSE;
+				Block[c + 7].IsROM = FALSE;
 			}
 		}
 	}
@@ -444,9 +449,9 @@ static void BSX_Map_BIOS (void)
 		{
 			for (i = c + 8; i < c + 16; i++)
 			{
-				Map[i] = &BIOSROM[(c << 11) % BIOS_SIZE] - 0x8000;
-				BlockIsRAM[i] = FALSE;
-				BlockIsROM[i] = TRUE;
+				Block[i].Map = &BIOSROM[(c << 11) % BIOS_SIZE] - 0x8000;
+				Block[i].IsRAM = FALSE;
+				Block[i].IsROM = TRUE;
 			}
 		}
 	}
@@ -458,9 +463,9 @@ static void BSX_Map_BIOS (void)
 		{
 			for (i = c + 8; i < c + 16; i++)
 			{
-				Map[i + 0x800] = &BIOSROM[(c << 11) % BIOS_SIZE] - 0x8000;
-				BlockIsRAM[i + 0x800] = FALSE;
-				BlockIsROM[i + 0x800] = TRUE;
+				Block[i + 0x800].Map = &BIOSROM[(c << 11) % BIOS_SIZE] - 0x8000;
+				Block[i + 0x800].IsRAM = FALSE;
+				Block[i + 0x800].IsROM = TRUE;
 			}
 		}
 	}
@@ -473,12 +478,12 @@ static void BSX_Map_RAM (void)
 	// Banks 7E->7F
 	for (c = 0; c < 16; c++)
 	{
-		Map[c + 0x7E0] = RAM;
-		Map[c + 0x7F0] = RAM + 0x10000;
-		BlockIsRAM[c + 0x7E0] = TRUE;
-		BlockIsRAM[c + 0x7F0] = TRUE;
-		BlockIsROM[c + 0x7E0] = FALSE;
-		BlockIsROM[c + 0x7F0] = FALSE;
+		Block[c + 0x7E0].Map = RAM;
+		Block[c + 0x7F0].Map = RAM + 0x10000;
+		Block[c + 0x7E0].IsRAM = TRUE;
+		Block[c + 0x7F0].IsRAM = TRUE;
+		Block[c + 0x7E0].IsROM = FALSE;
+		Block[c + 0x7F0].IsROM = FALSE;
 	}
 }
 
@@ -44,7 +44,7 @@ struct SBSX
 	uint16	sat_stream1_queue, sat_stream2_queue;
 };
 
-extern struct SBSX	BSX;
+extern S9X_TLS struct SBSX	BSX;
 
 uint8 S9xGetBSX (uint32);
 void S9xSetBSX (uint8, uint32);
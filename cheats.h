@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <string>
 #include <vector>
+#include "port.h"
 
 using bool8 = uint8_t;
 
@@ -73,8 +74,8 @@ typedef enum
 	S9X_32_BITS
 }	S9xCheatDataSize;
 
-extern SCheatData	Cheat;
-extern Watch		watches[16];
+extern S9X_TLS SCheatData	Cheat;
+extern S9X_TLS Watch		watches[16];
 
 int S9xAddCheatGroup(const std::string &name, const std::string &cheat);
 int S9xModifyCheatGroup(uint32_t index, const std::string &name, const std::string &cheat);
@@ -13,7 +13,7 @@
 static inline uint8 S9xGetByteFree(uint32 Address)
 {
     int block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-    uint8 *GetAddress = Memory.Map[block];
+    uint8 *GetAddress = Memory.Block[block].Map;
     uint8 byte;
 
     if (GetAddress >= (uint8 *)CMemory::MAP_LAST)
@@ -28,6 +28,16 @@ static inline uint8 S9xGetByteFree(uint32 Address)
         byte = S9xGetCPU(Address & 0xffff);
         return (byte);
 
+#ifdef USE_REX
+    case CMemory::MAP_REX_NMI:
+        byte = *(Memory.REXNMIBlock + (Address & 0xffff));
+        return (byte);
+
+    case CMemory::MAP_REX_2C00:
+        if ((Address & 0xfe00) == 0x2c00)
+            return (Memory.REX_2C00[Address & 0x1ff]);
+#endif
+        /* Fall through */
     case CMemory::MAP_PPU:
         if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
             return (OpenBus);
@@ -99,10 +109,19 @@ static inline uint8 S9xGetByteFree(uint32 Address)
 static inline void S9xSetByteFree(uint8 Byte, uint32 Address)
 {
     int block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-    uint8 *SetAddress = Memory.Map[block];
+    uint8 *SetAddress = Memory.Block[block].Map;
 
     if (SetAddress >= (uint8 *)CMemory::MAP_LAST)
     {
+        // patched ROM may already be predecoded, or shared with other instances
+        if (Memory.Block[block].IsROM && *(SetAddress + (Address & 0xffff)) != Byte)
+        {
+            S9xResetCPUBlockCache();
+#ifdef S9X_MULTI_INSTANCE
+            if (Memory.UnshareROM())
+                SetAddress = Memory.Block[block].Map;
+#endif
+        }
         *(SetAddress + (Address & 0xffff)) = Byte;
         return;
     }
@@ -113,6 +132,21 @@ static inline void S9xSetByteFree(uint8 Byte, uint32 Address)
         S9xSetCPU(Byte, Address & 0xffff);
         return;
 
+#ifdef USE_REX
+    case CMemory::MAP_REX_NMI:
+        if (*(Memory.REXNMIBlock + (Address & 0xffff)) != Byte)
+            S9xResetCPUBlockCache();
+        *(Memory.REXNMIBlock + (Address & 0xffff)) = Byte;
+        return;
+
+    case CMemory::MAP_REX_2C00:
+        if ((Address & 0xfe00) == 0x2c00)
+        {
+            Memory.REX_2C00[Address & 0x1ff] = Byte;
+            return;
+        }
+#endif
+        /* Fall through */
     case CMemory::MAP_PPU:
         if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
             return;
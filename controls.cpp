@@ -68,8 +68,11 @@ using namespace	std;
 #define FLAG_IOBIT1				(Memory.FillRAM[0x4213] & 0x80)
 #define FLAG_IOBIT(n)			((n) ? (FLAG_IOBIT1) : (FLAG_IOBIT0))
 
-bool8	pad_read = 0, pad_read_last = 0;
-uint8	read_idx[2 /* ports */][2 /* per port */];
+S9X_TLS bool8	pad_read = 0, pad_read_last = 0;
+S9X_TLS uint8	read_idx[2 /* ports */][2 /* per port */];
+static S9X_TLS void	(*input_latch_callback) (void) = NULL;
+static S9X_TLS bool8	input_latched = FALSE;
+static S9X_TLS bool8	input_latch_fired = FALSE;
 
 struct exemulti
 {
@@ -85,7 +88,7 @@ struct crosshair
 	uint8				fg, bg;
 };
 
-static struct
+static S9X_TLS struct
 {
 	int16				x, y;
 	int16				V_adj;
@@ -95,7 +98,7 @@ static struct
 	bool8				mapped;
 }	pseudopointer[8];
 
-static struct
+static S9X_TLS struct
 {
 	uint16				buttons;
 	uint16				turbos;
@@ -104,7 +107,7 @@ static struct
 	uint8				turbo_ct;
 }	joypad[8];
 
-static struct
+static S9X_TLS struct
 {
 	uint8				delta_x, delta_y;
 	int16				old_x, old_y;
@@ -114,7 +117,7 @@ static struct
 	struct crosshair	crosshair;
 }	mouse[2];
 
-static struct
+static S9X_TLS struct
 {
 	int16				x, y;
 	uint8				phys_buttons;
@@ -124,7 +127,7 @@ static struct
 	struct crosshair	crosshair;
 }	superscope;
 
-static struct
+static S9X_TLS struct
 {
 	int16				x[2], y[2];
 	uint8				buttons;
@@ -133,12 +136,12 @@ static struct
 	struct crosshair	crosshair[2];
 }	justifier;
 
-static struct
+static S9X_TLS struct
 {
 	int8				pads[4];
 }	mp5[2];
 
-static struct
+static S9X_TLS struct
 {
 	int16				x, y;
 	uint8				buttons;
@@ -146,16 +149,16 @@ static struct
 	struct crosshair	crosshair;
 }	macsrifle;
 
-static set<struct exemulti *>		exemultis;
-static set<uint32>					pollmap[NUMCTLS + 1];
-static map<uint32, s9xcommand_t>	keymap;
-static vector<s9xcommand_t *>		multis;
-static uint8						turbo_time;
-static uint8						pseudobuttons[256];
-static bool8						FLAG_LATCH = FALSE;
-static int32						curcontrollers[2] = { NONE,    NONE };
-static int32						newcontrollers[2] = { JOYPAD0, NONE };
-static char							buf[256];
+static S9X_TLS set<struct exemulti *>		exemultis;
+static S9X_TLS set<uint32>					pollmap[NUMCTLS + 1];
+static S9X_TLS map<uint32, s9xcommand_t>	keymap;
+static S9X_TLS vector<s9xcommand_t *>		multis;
+static S9X_TLS uint8						turbo_time;
+static S9X_TLS uint8						pseudobuttons[256];
+static S9X_TLS bool8						FLAG_LATCH = FALSE;
+static S9X_TLS int32						curcontrollers[2] = { NONE,    NONE };
+static S9X_TLS int32						newcontrollers[2] = { JOYPAD0, NONE };
+static S9X_TLS char							buf[256];
 
 static const char	*color_names[32] =
 {
@@ -785,7 +788,7 @@ void S9xGetController (int port, enum controllers *controller, int8 *id1, int8 *
 
 void S9xReportControllers (void)
 {
-	static char	mes[128];
+	static S9X_TLS char	mes[128];
 	char		*c = mes;
 
 	S9xVerifyControllers();
@@ -2811,6 +2814,25 @@ static void UpdatePolledMouse (int i)
 	}
 }
 
+void S9xSetInputLatchCallback (void (*callback) (void))
+{
+	input_latch_callback = callback;
+}
+
+bool S9xLateInputLatch (void)
+{
+	// movies and netplay sample the ports at the end of the frame, so the game must see what was reported before it
+	return (input_latch_callback && !S9xMovieActive() && !Settings.NetPlay);
+}
+
+bool S9xInputLatchFired (void)
+{
+	bool	fired = input_latch_fired;
+
+	input_latch_fired = FALSE;
+	return (fired);
+}
+
 void S9xSetJoypadLatch (bool latch)
 {
 	if (!latch && FLAG_LATCH)
@@ -2824,6 +2846,14 @@ void S9xSetJoypadLatch (bool latch)
 	{
 		int	i;
 
+		// reads shift out the state latched here, so this is as late as the input can be taken for this frame
+		if (!input_latched && S9xLateInputLatch())
+		{
+			input_latched = TRUE;
+			input_latch_fired = TRUE;
+			input_latch_callback();
+		}
+
 		for (int n = 0; n < 2; n++)
 		{
 			for (int j = 0; j < 2; j++)
@@ -3326,6 +3356,7 @@ void S9xControlEOF (void)
 
 	pad_read_last = pad_read;
 	pad_read      = false;
+	input_latched = FALSE;
 }
 
 void S9xSetControllerCrosshair (enum crosscontrols ctl, int8 idx, const char *fg, const char *bg)
@@ -220,6 +220,17 @@ void S9xReportAxis (uint32 id, int16 value);
 
 void S9xApplyCommand (s9xcommand_t cmd, int16 data1, int16 data2);
 
+// Late input latching.
+// With a callback set, snes9x calls it once per frame when the game first latches the controllers (auto-joypad or a $4016 write),
+// and the callback should report the current input then, instead of the port reporting it before running the frame.
+// S9xLateInputLatch() returns FALSE while a movie or netplay needs the input sampled at the frame boundary; report it as usual then.
+// S9xInputLatchFired() returns whether the callback ran since it was last asked, and forgets it. A frame the game never latches the
+// controllers in (lag frames, loading, no auto-joypad and no $4016 strobe) doesn't call it, so report the input after running such a frame.
+
+void S9xSetInputLatchCallback (void (*callback) (void));
+bool S9xLateInputLatch (void);
+bool S9xInputLatchFired (void);
+
 //////////
 // These functions are called by snes9x into your port, so each port should implement them.
 
@@ -13,9 +13,13 @@
 #include "srtc.h"
 #include "snapshot.h"
 #include "cheats.h"
+#include "profiler.h"
 #ifdef DEBUGGER
 #include "debug.h"
 #endif
+#ifdef USE_REX
+#include "rex.h"
+#endif
 
 static void S9xResetCPU (void);
 static void S9xSoftResetCPU (void);
@@ -47,6 +51,7 @@ static void S9xSoftResetCPU (void)
 	CPU.MemSpeed = SLOW_ONE_CYCLE;
 	CPU.MemSpeedx2 = SLOW_ONE_CYCLE * 2;
 	CPU.FastROMSpeed = SLOW_ONE_CYCLE;
+	Memory.UpdateBlockSpeeds();
 	CPU.InDMA = FALSE;
 	CPU.InHDMA = FALSE;
 	CPU.InDMAorHDMA = FALSE;
@@ -94,6 +99,22 @@ static void S9xSoftResetCPU (void)
 	S9xUnpackStatus();
 }
 
+#ifdef USE_REX
+// REX chip ops copy directly to and from these buffers, so a vector read never goes through the SNES bus
+static void S9xMapREXChips (void)
+{
+	uint32	sram_size = Memory.SRAMSize ? Memory.SRAMMask + 1 : 0;
+
+	if (sram_size > Memory.SRAM_SIZE)
+		sram_size = Memory.SRAM_SIZE;
+
+	rex_set_chip(REX_CHIP_WRAM, Memory.RAM, sizeof(Memory.RAM), TRUE);
+	rex_set_chip(REX_CHIP_SRAM, Memory.SRAM, sram_size, TRUE);
+	rex_set_chip(REX_CHIP_ROM, Memory.ROM, Memory.CalculatedSize, FALSE);
+	rex_set_chip(REX_CHIP_2C00, Memory.REX_2C00, sizeof(Memory.REX_2C00), TRUE);
+}
+#endif
+
 void S9xReset (void)
 {
 	S9xResetSaveTimer(FALSE);
@@ -102,10 +123,17 @@ void S9xReset (void)
 	memset(Memory.VRAM, 0x00, sizeof(Memory.VRAM));
 	memset(Memory.FillRAM, 0, 0x8000);
 #ifdef USE_REX
-	memset(Memory.REX_2C00, 0, 0x8000);
+	memset(Memory.REX_2C00, 0, sizeof(Memory.REX_2C00));
+	Memory.DisarmREXNMIHook();
+	S9xMapREXChips();
 #endif
 
 	S9xResetBSX();
+	S9xResetCPUBlockCache();
+	S9xResetIdleLoop();
+#ifdef CPU_PROFILER
+	S9xProfileResync();
+#endif
 	S9xResetCPU();
 	S9xResetPPU();
 	S9xResetDMA();
@@ -143,6 +171,11 @@ void S9xSoftReset (void)
 	if (Settings.BS)
 		S9xResetBSX();
 
+	S9xResetCPUBlockCache();
+	S9xResetIdleLoop();
+#ifdef CPU_PROFILER
+	S9xProfileResync();
+#endif
 	S9xSoftResetCPU();
 	S9xSoftResetPPU();
 	S9xResetDMA();
@@ -12,6 +12,10 @@
 #include "fxemu.h"
 #include "snapshot.h"
 #include "movie.h"
+#include "profiler.h"
+#ifdef USE_REX
+#include "rex.h"
+#endif
 #ifdef DEBUGGER
 #include "debug.h"
 #include "missing.h"
@@ -19,6 +23,330 @@
 
 static inline void S9xReschedule (void);
 
+// the slice S9xRunFor is running; Start is rebased at every line end like Timings.NextIRQTimer
+static S9X_TLS struct
+{
+	bool8	Active;
+	int32	Start;
+	int32	Cycles;
+}	RunFor;
+
+// the frames S9xMainLoopRunAhead runs past the one it keeps, and where it keeps it
+static S9X_TLS struct
+{
+	bool8	Hidden;
+	uint8	*State;
+	uint32	Size;
+}	RunAhead;
+
+#ifndef DEBUGGER
+// Predecoded straight-line runs of ROM code, so the main loop can skip the opcode fetch, the table lookup and
+// the block boundary check for every instruction after the first. Entries are keyed by the host address of the
+// first opcode and the opcode table (E/M/X) they were decoded with, so a bank remapped by the SA-1 or S-DD1
+// simply misses. Only blocks the CPU cannot write are decoded; cheats patching ROM reset the whole cache.
+#define CPU_BLOCK_CACHE_SIZE	4096
+#define CPU_BLOCK_MAX_OPS		16
+
+struct SCPUBlock
+{
+	uint8			*Code;
+	struct SOpcodes	*Opcodes;
+	uint32			Count;
+	void			(*Op[CPU_BLOCK_MAX_OPS]) (void);
+};
+
+static S9X_TLS struct SCPUBlock	CPUBlocks[CPU_BLOCK_CACHE_SIZE];
+
+// instructions that end a run: anything that moves PC or PB, changes E/M/X, or waits
+static const uint8	CPUBlockEnd[256] =
+{
+	// 0 1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
+	   1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,	// 0 BRK COP PHP
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 1 BPL
+	   1, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,	// 2 JSR JSL PLP
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 3 BMI
+	   1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,	// 4 RTI MVP JMP
+	   1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,	// 5 BVC MVN JML
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,	// 6 RTS RTL JMP
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,	// 7 BVS JMP
+	   1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 8 BRA BRL
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 9 BCC
+	   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// A
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// B BCS
+	   0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0,	// C REP WAI
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0,	// D BNE STP JML
+	   0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// E SEP
+	   1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0	// F BEQ XCE JSR
+};
+
+static bool8 S9xDecodeCPUBlock (struct SCPUBlock *b, uint8 *code)
+{
+	int		block = (Registers.PBPC & 0xffffff) >> MEMMAP_SHIFT;
+	uint32	pc = Registers.PCw;
+	uint32	n = 0;
+
+	// BS-X flash can be rewritten through MAP_BSX even where it reads as ROM
+	if (!Memory.Block[block].IsROM || Memory.Block[block].IsRAM || Memory.Block[block].WriteMap >= (uint8 *) CMemory::MAP_LAST || Settings.BS)
+		return (FALSE);
+
+	// stop short of any instruction that reaches into the next block, as the main loop would refetch PCBase:
+	while (n < CPU_BLOCK_MAX_OPS)
+	{
+		uint8	op = CPU.PCBase[pc];
+
+		if ((pc & MEMMAP_MASK) + ICPU.S9xOpLengths[op] >= MEMMAP_BLOCK_SIZE)
+			break;
+
+		b->Op[n++] = ICPU.S9xOpcodes[op].S9xOpcode;
+		pc += ICPU.S9xOpLengths[op];
+
+		if (CPUBlockEnd[op])
+			break;
+	}
+
+	b->Code = n ? code : NULL;
+	b->Opcodes = ICPU.S9xOpcodes;
+	b->Count = n;
+
+	return (n != 0);
+}
+
+// Runs the cached block at PB:PC. Between instructions it leaves for the main loop whenever the main loop would
+// have had something to do besides fetching the next opcode, so timing and interrupts are unchanged.
+static bool8 S9xRunCPUBlock (void)
+{
+	uint8				*code = CPU.PCBase + Registers.PCw;
+	uint8				*base = CPU.PCBase;
+	struct SCPUBlock	*b = &CPUBlocks[((pint) code ^ ((pint) ICPU.S9xOpcodes >> 4)) & (CPU_BLOCK_CACHE_SIZE - 1)];
+
+	if (b->Code != code || b->Opcodes != ICPU.S9xOpcodes)
+	{
+		if (!S9xDecodeCPUBlock(b, code))
+			return (FALSE);
+	}
+
+	for (uint32 i = 0; i < b->Count; i++)
+	{
+		CPU.Cycles += CPU.MemSpeed;
+		PROFILE_OP(CPUProfile, CPU.Cycles, Registers.PBPC, base[Registers.PCw]);
+		Registers.PCw++;
+		(*b->Op[i])();
+
+		if (Settings.SA1 && Settings.SA1SyncCycles <= 0)
+			S9xSA1MainLoop();
+
+		if (CPU.NMIPending || CPU.IRQLine || CPU.IRQExternal || Timings.IRQFlagChanging ||
+			CPU.Cycles >= Timings.NextIRQTimer || (CPU.Flags & (SCAN_KEYS_FLAG | RUN_FOR_FLAG)) || CPU.PCBase != base)
+			break;
+	}
+
+	return (TRUE);
+}
+#endif
+
+void S9xResetCPUBlockCache (void)
+{
+#ifndef DEBUGGER
+	memset(CPUBlocks, 0, sizeof(CPUBlocks));
+#endif
+}
+
+#ifndef DEBUGGER
+// Idle loop skipping. A game waiting for NMI or H-blank spins on a few instructions that only read WRAM, ROM,
+// RDNMI or HVBJOY, and none of those change before the next H event. When the same backward branch is taken twice
+// with the same registers and no event or interrupt in between, every further iteration repeats the last one, so
+// whole iterations are skipped up to the next event, IRQ timer or NMI and the timing is unchanged.
+#define IDLE_IMP	1
+#define IDLE_IMM	2
+#define IDLE_DP		3
+#define IDLE_ABS	4
+#define IDLE_LONG	5
+#define IDLE_REL	6
+#define IDLE_INDEX	8	// operand width follows X rather than M
+
+// instructions allowed in an idle loop: no stores, stack, jumps or changes to D, DB, E, M or X
+static const uint8	IdleLoopOp[256] =
+{
+	// 0 1  2  3   4   5  6  7  8  9   A  B  C   D  E   F
+	   0, 0, 0, 0, 0,  3, 0, 0, 0, 2,  1, 0, 0,  4, 0,  5,	// 0 ORA ASL
+	   6, 0, 0, 0, 0,  0, 0, 0, 1, 0,  1, 0, 0,  0, 0,  0,	// 1 BPL CLC INC
+	   0, 0, 0, 0, 3,  3, 0, 0, 0, 2,  1, 0, 4,  4, 0,  5,	// 2 BIT AND ROL
+	   6, 0, 0, 0, 0,  0, 0, 0, 1, 0,  1, 0, 0,  0, 0,  0,	// 3 BMI SEC DEC
+	   0, 0, 0, 0, 0,  3, 0, 0, 0, 2,  1, 0, 0,  4, 0,  5,	// 4 EOR LSR
+	   6, 0, 0, 0, 0,  0, 0, 0, 0, 0,  0, 0, 0,  0, 0,  0,	// 5 BVC
+	   0, 0, 0, 0, 0,  3, 0, 0, 0, 2,  1, 0, 0,  4, 0,  5,	// 6 ADC ROR
+	   6, 0, 0, 0, 0,  0, 0, 0, 0, 0,  0, 0, 0,  0, 0,  0,	// 7 BVS
+	   6, 0, 0, 0, 0,  0, 0, 0, 1, 2,  1, 0, 0,  0, 0,  0,	// 8 BRA DEY BIT TXA
+	   6, 0, 0, 0, 0,  0, 0, 0, 1, 0,  0, 1, 0,  0, 0,  0,	// 9 BCC TYA TXY
+	  10, 0,10, 0,11,  3,11, 0, 1, 2,  1, 0,12,  4,12,  5,	// A LDY LDA LDX TAY TAX
+	   6, 0, 0, 0, 0,  0, 0, 0, 1, 0,  0, 1, 0,  0, 0,  0,	// B BCS CLV TYX
+	  10, 0, 0, 0,11,  3, 0, 0, 1, 2,  1, 0,12,  4, 0,  5,	// C CPY CMP INY DEX
+	   6, 0, 0, 0, 0,  0, 0, 0, 0, 0,  0, 0, 0,  0, 0,  0,	// D BNE
+	  10, 0, 0, 0,11,  3, 0, 0, 1, 2,  1, 1,12,  4, 0,  5,	// E CPX SBC INX NOP XBA
+	   6, 0, 0, 0, 0,  0, 0, 0, 0, 0,  0, 0, 0,  0, 0,  0	// F BEQ
+};
+
+static S9X_TLS struct
+{
+	uint32				End;		// PB:PC just past the branch, 0 while no loop is being watched
+	uint16				Start;
+	int8				Verdict;	// 0: not checked since the last change, 1: idle, -1: not idle
+	int32				Cycles;
+	int32				NextEvent;
+	int32				NextIRQTimer;
+	int32				V_Counter;
+	uint8				Flags[5];
+	struct SRegisters	Registers;
+}	IdleLoop;
+
+static bool8 S9xIdleLoopSafeRead (uint32 address)
+{
+	struct SMemBlock	*block = &Memory.Block[(address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8				*ptr = block->Map;
+
+	if (ptr >= (uint8 *) CMemory::MAP_LAST)
+	{
+		ptr += address & 0xffff;
+		if (ptr >= Memory.RAM && ptr < Memory.RAM + sizeof(Memory.RAM))
+			return (TRUE);
+
+		// BS-X flash can be rewritten through MAP_BSX even where it reads as ROM
+		return (block->IsROM && !block->IsRAM && !Settings.BS);
+	}
+
+	// RDNMI only changes when V-blank starts, HVBJOY at line boundaries, Timings.HBlankStart and Timings.HBlankEnd
+	return (ptr == (uint8 *) CMemory::MAP_CPU && ((address & 0xffff) == 0x4210 || (address & 0xffff) == 0x4212));
+}
+
+static int8 S9xIdleLoopVerdict (uint16 start, uint16 end)
+{
+	uint32	pc = start;
+
+	// the whole loop must sit in the block CPU.PCBase points to, including the main loop's lookahead
+	if (!CPU.PCBase || ((start ^ (end + 3)) & ~MEMMAP_MASK))
+		return (-1);
+
+	while (pc < (uint32) end - 2)
+	{
+		uint8	op = CPU.PCBase[pc];
+		uint8	mode = IdleLoopOp[op];
+		bool8	wide = (mode & IDLE_INDEX) ? !CheckIndex() : !CheckMemory();
+		uint32	address;
+
+		switch (mode & ~IDLE_INDEX)
+		{
+			case IDLE_IMP:
+			case IDLE_IMM:
+				break;
+
+			case IDLE_REL:
+				// branches may only stay inside the loop, so every iteration ends on the watched branch
+				address = (pc + 2 + (int8) CPU.PCBase[pc + 1]) & 0xffff;
+				if (address < start || address > (uint32) end - 2)
+					return (-1);
+				break;
+
+			case IDLE_DP:
+				address = (Registers.D.W + CPU.PCBase[pc + 1]) & 0xffff;
+				if (!S9xIdleLoopSafeRead(address) || (wide && !S9xIdleLoopSafeRead((address + 1) & 0xffff)))
+					return (-1);
+				break;
+
+			case IDLE_ABS:
+				address = ICPU.ShiftedDB + READ_WORD(CPU.PCBase + pc + 1);
+				if (!S9xIdleLoopSafeRead(address) || (wide && !S9xIdleLoopSafeRead(address + 1)))
+					return (-1);
+				break;
+
+			case IDLE_LONG:
+				address = READ_3WORD(CPU.PCBase + pc + 1);
+				if (!S9xIdleLoopSafeRead(address) || (wide && !S9xIdleLoopSafeRead(address + 1)))
+					return (-1);
+				break;
+
+			default:
+				return (-1);
+		}
+
+		pc += ICPU.S9xOpLengths[op];
+	}
+
+	return (pc == (uint32) end - 2 ? 1 : -1);
+}
+
+// Called from every backward branch with PC just past the operand; taken is FALSE when the loop is left.
+void S9xCheckIdleLoop (uint16 start, bool8 taken)
+{
+	uint8	flags[5] = { ICPU._Carry, ICPU._Zero, ICPU._Negative, ICPU._Overflow, OpenBus };
+	int32	previous = IdleLoop.Cycles;
+
+	if (!taken || Settings.SA1 || SNESGameFixes.IdleLoops < 0 || (Settings.SkipIdleLoops < 2 && SNESGameFixes.IdleLoops <= 0))
+	{
+		IdleLoop.End = 0;
+		return;
+	}
+
+	IdleLoop.Cycles = CPU.Cycles;
+
+	if (IdleLoop.End != Registers.PBPC || IdleLoop.Start != start || IdleLoop.NextEvent != CPU.NextEvent ||
+		IdleLoop.NextIRQTimer != Timings.NextIRQTimer || IdleLoop.V_Counter != CPU.V_Counter || CPU.Cycles <= previous ||
+		memcmp(IdleLoop.Flags, flags, sizeof(flags)) || memcmp(&IdleLoop.Registers, &Registers, sizeof(Registers)))
+	{
+		IdleLoop.End = Registers.PBPC;
+		IdleLoop.Start = start;
+		IdleLoop.Verdict = 0;
+		IdleLoop.NextEvent = CPU.NextEvent;
+		IdleLoop.NextIRQTimer = Timings.NextIRQTimer;
+		IdleLoop.V_Counter = CPU.V_Counter;
+		memcpy(IdleLoop.Flags, flags, sizeof(flags));
+		memcpy(&IdleLoop.Registers, &Registers, sizeof(Registers));
+		return;
+	}
+
+	if (!IdleLoop.Verdict)
+		IdleLoop.Verdict = S9xIdleLoopVerdict(start, Registers.PCw);
+
+	if (IdleLoop.Verdict < 0 || CPU.NMIPending || CPU.IRQLine || CPU.IRQExternal || Timings.IRQFlagChanging)
+		return;
+
+	int32	target = CPU.NextEvent;
+	int32	length = CPU.Cycles - previous;
+
+	if (Timings.NextIRQTimer < target)
+		target = Timings.NextIRQTimer;
+
+	// HVBJOY bit 6 drops at HBlankEnd and rises at HBlankStart, and neither is an event
+	if (previous < Timings.HBlankEnd)
+	{
+		if (CPU.Cycles >= Timings.HBlankEnd)
+			return;
+		if (Timings.HBlankEnd < target)
+			target = Timings.HBlankEnd;
+	}
+
+	if (previous < Timings.HBlankStart)
+	{
+		if (CPU.Cycles >= Timings.HBlankStart)
+			return;
+		if (Timings.HBlankStart < target)
+			target = Timings.HBlankStart;
+	}
+
+	if (target > CPU.Cycles + length)
+	{
+		CPU.Cycles += (target - 1 - CPU.Cycles) / length * length;
+		IdleLoop.Cycles = CPU.Cycles;
+	}
+}
+#endif
+
+void S9xResetIdleLoop (void)
+{
+#ifndef DEBUGGER
+	memset(&IdleLoop, 0, sizeof(IdleLoop));
+#endif
+}
+
 void S9xMainLoop (void)
 {
 	#define CHECK_FOR_IRQ_CHANGE() \
@@ -42,6 +370,9 @@ void S9xMainLoop (void)
 		S9xMovieUpdate();
 	}
 
+	// picks up overclock settings the frontend changed since the last frame
+	Memory.UpdateBlockSpeeds();
+
 	for (;;)
 	{
 		if (CPU.NMIPending)
@@ -130,11 +461,16 @@ void S9xMainLoop (void)
 		}
 	#endif
 
-		if (CPU.Flags & SCAN_KEYS_FLAG)
+		if (CPU.Flags & (SCAN_KEYS_FLAG | RUN_FOR_FLAG))
 		{
 			break;
 		}
 
+	#ifndef DEBUGGER
+		if (Settings.CPUBlockCache && CPU.PCBase && CPU.Cycles <= 1000000 && S9xRunCPUBlock())
+			continue;
+	#endif
+
 		uint8				Op;
 		struct	SOpcodes	*Opcodes;
 
@@ -168,56 +504,240 @@ void S9xMainLoop (void)
 				Opcodes = S9xOpcodesSlow;
 		}
 
+		PROFILE_OP(CPUProfile, CPU.Cycles, Registers.PBPC, Op);
 		Registers.PCw++;
 		(*Opcodes[Op].S9xOpcode)();
 
-		if (Settings.SA1)
+		if (Settings.SA1 && Settings.SA1SyncCycles <= 0)
 			S9xSA1MainLoop();
 	}
 
 	S9xPackStatus();
 }
 
-static inline void S9xReschedule (void)
+// Runs until about 'cycles' master cycles have passed, stopping at the first instruction boundary after them, or
+// until the frame ends like S9xMainLoop does. Returns the master cycles actually run; SCAN_KEYS_FLAG tells a frame
+// end apart. The next call, or S9xMainLoop, carries on exactly where this one stopped.
+int32 S9xRunFor (int32 cycles)
 {
-	switch (CPU.WhichEvent)
+	if (cycles <= 0)
+		return (0);
+
+	RunFor.Active = TRUE;
+	RunFor.Start = CPU.Cycles;
+	RunFor.Cycles = cycles;
+
+	S9xWakeHEvent(HC_RUN_FOR_EVENT);
+
+	S9xMainLoop();
+
+	RunFor.Active = FALSE;
+	CPU.Flags &= ~RUN_FOR_FLAG;
+
+	// a frame end got there first: take the stop back out of the schedule
+	if (CPU.WhichEvent == HC_RUN_FOR_EVENT)
+		S9xReschedule();
+
+	return (CPU.Cycles - RunFor.Start);
+}
+
+// Runs the next frame and then Settings.RunAheadFrames more, so what is shown is that many frames ahead of where the
+// game really is and input shows up on screen that much sooner. Only the first frame is kept: it is run with its
+// sound but no picture and saved, the frames after it are run silently with only the last one drawn, and the saved
+// state is loaded back. Movies and netplay count every emulated frame, so with them this is just S9xMainLoop.
+void S9xMainLoopRunAhead (void)
+{
+	if (!Settings.RunAheadFrames || S9xMovieActive() || Settings.NetPlay)
 	{
-		case HC_HBLANK_START_EVENT:
-			CPU.WhichEvent = HC_HDMA_START_EVENT;
-			CPU.NextEvent  = Timings.HDMAStart;
-			break;
+		S9xMainLoop();
+		return;
+	}
+
+	bool8	render = IPPU.RenderThisFrame;
+
+	IPPU.RenderThisFrame = FALSE;
+	S9xMainLoop();
+
+	// S9xSyncSpeed may have decided about the next frame
+	bool8	next = IPPU.RenderThisFrame;
+
+	// these states never leave this instance: load them in place and leave the screenshot out
+	bool8	fast = Settings.FastSavestates, screenshots = Settings.SnapshotScreenshots;
+	Settings.FastSavestates = TRUE;
+	Settings.SnapshotScreenshots = FALSE;
+
+	uint32	size = S9xFreezeSize();
+	if (size > RunAhead.Size)
+	{
+		uint8	*state = (uint8 *) realloc(RunAhead.State, size);
+
+		if (state)
+		{
+			RunAhead.State = state;
+			RunAhead.Size = size;
+		}
+	}
+
+	if (size <= RunAhead.Size && S9xFreezeGameMem(RunAhead.State, size))
+	{
+		// not in snapshots, and SRAM from a frame that will be run again must not be autosaved
+		uint32	autosave_timer = CPU.AutoSaveTimer;
+		bool8	sram_modified = CPU.SRAMModified;
+		CPU.AutoSaveTimer = 0;
+		CPU.SRAMModified = FALSE;
+
+	#ifdef USE_REX
+		// nor is the FX Pak buffer or whether its NMI hook is armed; the VMs themselves sit the hidden frames out
+		uint8	rex_2c00[sizeof(Memory.REX_2C00)];
+		bool8	rex_nmi_armed = Memory.REXNMIBlock != NULL;
+		memcpy(rex_2c00, Memory.REX_2C00, sizeof(rex_2c00));
+	#endif
+
+		RunAhead.Hidden = TRUE;
+		S9xDiscardSamples(TRUE);
+
+		for (uint32 i = 1; i <= Settings.RunAheadFrames; i++)
+		{
+			IPPU.RenderThisFrame = (i == Settings.RunAheadFrames) ? render : FALSE;
+			S9xMainLoop();
+		}
+
+		S9xDiscardSamples(FALSE);
+		RunAhead.Hidden = FALSE;
+
+		S9xUnfreezeGameMem(RunAhead.State, size);
 
+	#ifdef USE_REX
+		memcpy(Memory.REX_2C00, rex_2c00, sizeof(rex_2c00));
+		if (rex_nmi_armed)
+			Memory.ArmREXNMIHook();
+		else
+			Memory.DisarmREXNMIHook();
+	#endif
+
+		CPU.AutoSaveTimer = autosave_timer;
+		CPU.SRAMModified = sram_modified;
+	}
+
+	IPPU.RenderThisFrame = next;
+	Settings.FastSavestates = fast;
+	Settings.SnapshotScreenshots = screenshots;
+}
+
+// Every event is a master-clock position within the current scanline that only depends on Timings and Settings,
+// so picking the next one needs nothing but the event that just fired, and snapshots that recorded WhichEvent and
+// NextEvent resume the same schedule. An event with nothing to do on this line has no position, so lines without
+// HDMA or rendering, and the HBlank start that only ever marked a position, cost no calls at all; whatever gives
+// one of them work again mid-line calls S9xWakeHEvent. Events at the same position fire in EventOrder, lowest first.
+static const uint8	EventOrder[HC_EVENT_COUNT] =
+{
+	0,
+	5,	// HC_HBLANK_START_EVENT
+	6,	// HC_HDMA_START_EVENT
+	8,	// HC_HCOUNTER_MAX_EVENT
+	1,	// HC_HDMA_INIT_EVENT
+	2,	// HC_RENDER_EVENT
+	3,	// HC_WRAM_REFRESH_EVENT
+	4,	// HC_REX_EVENT
+	7,	// HC_SUPERFX_EVENT
+	0,	// HC_SA1_EVENT
+	9	// HC_RUN_FOR_EVENT
+};
+
+static inline int32 S9xEventPosition (int which, int32 after)
+{
+	switch (which)
+	{
 		case HC_HDMA_START_EVENT:
-			CPU.WhichEvent = HC_HCOUNTER_MAX_EVENT;
-			CPU.NextEvent  = Timings.H_Max;
-			break;
+			return (PPU.HDMA && CPU.V_Counter <= PPU.ScreenHeight ? Timings.HDMAStart : -1);
 
 		case HC_HCOUNTER_MAX_EVENT:
-			CPU.WhichEvent = HC_HDMA_INIT_EVENT;
-			CPU.NextEvent  = Timings.HDMAInit;
-			break;
+			return (Timings.H_Max);
 
 		case HC_HDMA_INIT_EVENT:
-			CPU.WhichEvent = HC_RENDER_EVENT;
-			CPU.NextEvent  = Timings.RenderPos;
-			break;
+			return (CPU.V_Counter == 0 ? Timings.HDMAInit : -1);
 
 		case HC_RENDER_EVENT:
-			CPU.WhichEvent = HC_WRAM_REFRESH_EVENT;
-			CPU.NextEvent  = Timings.WRAMRefreshPos;
-			break;
+			return (CPU.V_Counter >= FIRST_VISIBLE_LINE && CPU.V_Counter <= PPU.ScreenHeight ? Timings.RenderPos : -1);
 
 		case HC_WRAM_REFRESH_EVENT:
-			CPU.WhichEvent = HC_HBLANK_START_EVENT;
-			CPU.NextEvent  = Timings.HBlankStart;
-			break;
+			return (Timings.WRAMRefreshPos);
+
+	#ifdef USE_REX
+		case HC_REX_EVENT:
+			// REX VMs only get an event while at least one of them has work to do
+			return (rex.active ? Timings.HBlankStart : -1);
+	#endif
+
+		case HC_SUPERFX_EVENT:
+			// the GSU runs one slice per scanline unless a register access already caught it up
+			return (Settings.SuperFX ? Timings.H_Max : -1);
+
+		case HC_SA1_EVENT:
+			// the next multiple of the sync interval, instead of after every CPU instruction
+			if (!Settings.SA1 || Settings.SA1SyncCycles <= 0)
+				return (-1);
+			return ((after < 0 ? 0 : after / Settings.SA1SyncCycles + 1) * Settings.SA1SyncCycles);
+
+		case HC_RUN_FOR_EVENT:
+			// the end of an S9xRunFor slice until it is reached
+			return (RunFor.Active && !(CPU.Flags & RUN_FOR_FLAG) ? RunFor.Start + RunFor.Cycles : -1);
+
+		default:
+			return (-1);
+	}
+}
+
+// Picks the earliest event after position 'after' (and after events at that position that fire before 'which').
+static void S9xScheduleNextEvent (int32 after, int which)
+{
+	uint8	order = which < HC_EVENT_COUNT ? EventOrder[which] : 0;
+	int		next = HC_HCOUNTER_MAX_EVENT;
+	int32	when = Timings.H_Max;
+
+	for (int i = 1; i < HC_EVENT_COUNT; i++)
+	{
+		int32	pos = S9xEventPosition(i, after);
+
+		if (pos < 0 || pos > Timings.H_Max || pos < after || (pos == after && EventOrder[i] <= order))
+			continue;
+
+		if (pos < when || (pos == when && EventOrder[i] < EventOrder[next]))
+		{
+			next = i;
+			when = pos;
+		}
+	}
+
+	CPU.WhichEvent = next;
+	CPU.NextEvent  = when;
+}
+
+static inline void S9xReschedule (void)
+{
+	S9xScheduleNextEvent(CPU.NextEvent, CPU.WhichEvent);
+}
+
+// Register writes land before their access is clocked, so an event that is still ahead of CPU.Cycles has not fired
+// on this line and can be brought forward if it now comes before the pending one.
+void S9xWakeHEvent (int which)
+{
+	int32	pos = S9xEventPosition(which, CPU.Cycles);
+
+	if (pos <= CPU.Cycles || pos > Timings.H_Max)
+		return;
+
+	if (pos < CPU.NextEvent || (pos == CPU.NextEvent && EventOrder[which] < EventOrder[CPU.WhichEvent]))
+	{
+		CPU.WhichEvent = which;
+		CPU.NextEvent  = pos;
 	}
 }
 
 void S9xDoHEventProcessing (void)
 {
 #ifdef DEBUGGER
-	static char	eventname[7][32] =
+	static char	eventname[HC_EVENT_COUNT][32] =
 	{
 		"",
 		"HC_HBLANK_START_EVENT",
@@ -225,7 +745,11 @@ void S9xDoHEventProcessing (void)
 		"HC_HCOUNTER_MAX_EVENT",
 		"HC_HDMA_INIT_EVENT   ",
 		"HC_RENDER_EVENT      ",
-		"HC_WRAM_REFRESH_EVENT"
+		"HC_WRAM_REFRESH_EVENT",
+		"HC_REX_EVENT         ",
+		"HC_SUPERFX_EVENT     ",
+		"HC_SA1_EVENT         ",
+		"HC_RUN_FOR_EVENT     "
 	};
 #endif
 
@@ -255,23 +779,25 @@ void S9xDoHEventProcessing (void)
 			break;
 
 		case HC_HCOUNTER_MAX_EVENT:
-			if (Settings.SuperFX)
-			{
-				if (!SuperFX.oneLineDone)
-					S9xSuperFXExec();
-				SuperFX.oneLineDone = FALSE;
-			}
-
 			S9xAPUEndScanline();
+			PROFILE_LINE(CPUProfile, Timings.H_Max);
 			CPU.Cycles -= Timings.H_Max;
 			if (Timings.NMITriggerPos != 0xffff)
 				Timings.NMITriggerPos -= Timings.H_Max;
 			if (Timings.NextIRQTimer != 0x0fffffff)
 				Timings.NextIRQTimer -= Timings.H_Max;
+			if (RunFor.Active)
+				RunFor.Start -= Timings.H_Max;
 			S9xAPUSetReferenceTime(CPU.Cycles);
 
 			if (Settings.SA1)
+			{
+				// a sliced SA-1 finishes the line before its clock is rebased with the CPU's
+				if (Settings.SA1SyncCycles > 0)
+					S9xSA1MainLoop();
+				PROFILE_LINE(SA1Profile, Timings.H_Max * 3);
 				SA1.Cycles -= Timings.H_Max * 3;
+			}
 
 			CPU.V_Counter++;
 			if (CPU.V_Counter >= Timings.V_Max)	// V ranges from 0 to Timings.V_Max - 1
@@ -331,11 +857,23 @@ void S9xDoHEventProcessing (void)
 					if (!(CPU.Flags & FRAME_ADVANCE_FLAG))
 				#endif
 				{
-					S9xSyncSpeed();
+					// frames run ahead are neither paced nor heard
+					if (!RunAhead.Hidden)
+						S9xSyncSpeed();
 				}
 
 				CPU.Flags |= SCAN_KEYS_FLAG;
 
+			#ifdef USE_REX
+				// wake VMs parked until NMI whether or not the game has NMI enabled in $4200
+				if (!RunAhead.Hidden)
+					rex_signal_nmi();
+
+				// like the FX Pak, send the next NMI to $2C00 while its first byte is non-zero
+				if (Memory.REX_2C00[0])
+					Memory.ArmREXNMIHook();
+			#endif
+
 				PPU.HDMA = 0;
 				// Bits 7 and 6 of $4212 are computed when read in S9xGetPPU.
 			#ifdef DEBUGGER
@@ -386,7 +924,7 @@ void S9xDoHEventProcessing (void)
 			if (CPU.V_Counter == FIRST_VISIBLE_LINE)	// V=1
 				S9xStartScreenRefresh();
 
-			S9xReschedule();
+			S9xScheduleNextEvent(-1, 0);
 
 			break;
 
@@ -399,6 +937,7 @@ void S9xDoHEventProcessing (void)
 				S9xTraceFormattedMessage("*** HDMA Init     HC:%04d, Channel:%02x", CPU.Cycles, PPU.HDMA);
 			#endif
 				S9xStartHDMA();
+				S9xWakeHEvent(HC_HDMA_START_EVENT);
 			}
 
 			break;
@@ -420,6 +959,44 @@ void S9xDoHEventProcessing (void)
 
 			S9xReschedule();
 
+			break;
+
+		case HC_REX_EVENT:
+		#ifdef USE_REX
+			// one batched slice per scanline, shared by the runnable VMs. their state and the responses they queue
+			// are not in snapshots, so frames run ahead and then loaded over must not advance them
+			if (!RunAhead.Hidden)
+				rex_exec_slice(Timings.H_Max, CPU.V_Counter);
+		#endif
+
+			S9xReschedule();
+
+			break;
+
+		case HC_SUPERFX_EVENT:
+			S9xReschedule();
+
+			if (!SuperFX.oneLineDone)
+				S9xSuperFXExec();
+			SuperFX.oneLineDone = FALSE;
+
+			break;
+
+		case HC_RUN_FOR_EVENT:
+			CPU.Flags |= RUN_FOR_FLAG;
+			S9xReschedule();
+			break;
+
+		case HC_SA1_EVENT:
+			S9xReschedule();
+
+			S9xSA1MainLoop();
+
+			break;
+
+		default:
+			S9xReschedule();
+
 			break;
 	}
 
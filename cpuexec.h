@@ -31,7 +31,7 @@ struct SICPU
 	uint32	FrameAdvanceCount;
 };
 
-extern struct SICPU		ICPU;
+extern S9X_TLS struct SICPU		ICPU;
 
 extern struct SOpcodes	S9xOpcodesE1[256];
 extern struct SOpcodes	S9xOpcodesM1X1[256];
@@ -45,9 +45,15 @@ extern uint8			S9xOpLengthsM0X1[256];
 extern uint8			S9xOpLengthsM0X0[256];
 
 void S9xMainLoop (void);
+int32 S9xRunFor (int32);
+void S9xMainLoopRunAhead (void);
+void S9xResetCPUBlockCache (void);
+void S9xResetIdleLoop (void);
+void S9xCheckIdleLoop (uint16, bool8);
 void S9xReset (void);
 void S9xSoftReset (void);
 void S9xDoHEventProcessing (void);
+void S9xWakeHEvent (int);
 
 static inline void S9xUnpackStatus (void)
 {
@@ -105,11 +105,14 @@ static void Op##OP (void) \
 		AddCycles(ONE_CYCLE); \
 		if (E && Registers.PCh != newPC.B.h) \
 			AddCycles(ONE_CYCLE); \
+		CHECK_FOR_IDLE_LOOP(newPC.W, TRUE); \
 		if ((Registers.PCw & ~MEMMAP_MASK) != (newPC.W & ~MEMMAP_MASK)) \
 			S9xSetPCBase(ICPU.ShiftedPB + newPC.W); \
 		else \
 			Registers.PCw = newPC.W; \
 	} \
+	else \
+		CHECK_FOR_IDLE_LOOP(newPC.W, FALSE); \
 }
 
 
@@ -22,6 +22,12 @@
 #define AddCycles(n)	{ CPU.Cycles += (n); while (CPU.Cycles >= CPU.NextEvent) S9xDoHEventProcessing(); }
 #endif
 
+#if defined(SA1_OPCODES) || defined(DEBUGGER)
+#define CHECK_FOR_IDLE_LOOP(pc, taken)	{}
+#else
+#define CHECK_FOR_IDLE_LOOP(pc, taken)	{ if (Settings.SkipIdleLoops && (pc) < Registers.PCw) S9xCheckIdleLoop(pc, taken); }
+#endif
+
 #include "cpuaddr.h"
 #include "cpuops.h"
 #include "cpumacro.h"
@@ -2700,13 +2706,6 @@ void S9xOpcode_NMI (void)
 		else
 		{
 			uint16	addr = S9xGetWord(0xFFEA);
-#ifdef USE_REX
-			// jump to buffer at $2C00 if the first byte is non-zero (emulate SD2SNES / FX Pak Pro behavior)
-			if (Memory.REX_2C00[0] != 0)
-			{
-				addr = 0x2C00;
-			}
-#endif
 			OpenBus = addr >> 8;
 			S9xSetPCBase(addr);
 		}
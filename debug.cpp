@@ -18,7 +18,7 @@
 
 #include "apu/bapu/snes/snes.hpp"
 
-extern SDMA	DMA[8];
+extern S9X_TLS SDMA	DMA[8];
 extern FILE	*apu_trace;
 FILE		*trace = NULL, *trace2 = NULL;
 
@@ -166,7 +166,7 @@ static void debug_whats_missing (void);
 static uint8 S9xDebugGetByte (uint32 Address)
 {
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*GetAddress = Memory.Map[block];
+	uint8	*GetAddress = Memory.Block[block].Map;
 	uint8	byte = 0;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
@@ -213,7 +213,7 @@ static uint16 S9xDebugGetWord (uint32 Address)
 static uint8 S9xDebugSA1GetByte (uint32 Address)
 {
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*GetAddress = SA1.Map[block];
+	uint8	*GetAddress = SA1.Block[block].Map;
 	uint8	byte = 0;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
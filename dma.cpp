@@ -16,11 +16,11 @@
 
 #define ADD_CYCLES(n)	{ CPU.Cycles += (n); }
 
-extern uint8	*HDMAMemPointers[8];
+extern S9X_TLS uint8	*HDMAMemPointers[8];
 extern int		HDMA_ModeByteCounts[8];
-extern SPC7110	s7emu;
+extern S9X_TLS SPC7110	s7emu;
 
-static uint8	sdd1_decode_buffer[0x10000];
+static S9X_TLS uint8	sdd1_decode_buffer[0x10000];
 
 static inline bool8 addCyclesInDMA (uint8);
 static inline bool8 HDMAReadLineCount (int);
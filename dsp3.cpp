@@ -7,7 +7,7 @@
 #include "snes9x.h"
 #include "memmap.h"
 
-static void (*SetDSP3) (void);
+static S9X_TLS void (*SetDSP3) (void);
 
 static const uint16	DSP3_DataROM[1024] =
 {
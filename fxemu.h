@@ -23,7 +23,7 @@ struct FxInfo_s
 	bool8	oneLineDone;
 };
 
-extern struct FxInfo_s	SuperFX;
+extern S9X_TLS struct FxInfo_s	SuperFX;
 
 void S9xInitSuperFX (void);
 void S9xResetSuperFX (void);
@@ -202,7 +202,7 @@ struct FxRegs_s
 	uint8	*avRegAddr;					// To reference avReg in snapshot.cpp
 };
 
-extern struct FxRegs_s	GSU;
+extern S9X_TLS struct FxRegs_s	GSU;
 
 // GSU registers
 #define GSU_R0			0x000
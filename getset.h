@@ -33,7 +33,7 @@
 			S9xDoHEventProcessing(); \
 	}
 
-extern uint8	OpenBus;
+extern S9X_TLS uint8	OpenBus;
 
 static inline int32 memory_speed (uint32 address)
 {
@@ -54,11 +54,21 @@ static inline int32 memory_speed (uint32 address)
 	return (TWO_CYCLES);
 }
 
+static inline int32 block_speed (int block, uint32 address)
+{
+	int32	speed = Memory.Block[block].Speed;
+
+	if (speed > 0)
+		return (speed);
+
+	return (speed ? CPU.FastROMSpeed : memory_speed(address));
+}
+
 inline uint8 S9xGetByte (uint32 Address)
 {
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*GetAddress = Memory.Map[block];
-	int32	speed = memory_speed(Address);
+	uint8	*GetAddress = Memory.Block[block].Map;
+	int32	speed = block_speed(block, Address);
 	uint8	byte;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
@@ -75,6 +85,31 @@ inline uint8 S9xGetByte (uint32 Address)
 			addCyclesInMemoryAccess;
 			return (byte);
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_NMI:
+			// armed FX Pak hook: the vector fetch reads $2C00, then the block goes back to normal
+			if ((Address & 0xffff) == 0xffea)
+				byte = 0x00;
+			else
+			if ((Address & 0xffff) == 0xffeb)
+			{
+				byte = 0x2c;
+				Memory.DisarmREXNMIHook();
+			}
+			else
+				byte = *(Memory.REXNMIBlock + (Address & 0xffff));
+			addCyclesInMemoryAccess;
+			return (byte);
+
+		case CMemory::MAP_REX_2C00:
+			if ((Address & 0xfe00) == 0x2c00)
+			{
+				byte = Memory.REX_2C00[Address & 0x1ff];
+				addCyclesInMemoryAccess;
+				return (byte);
+			}
+	#endif
+			/* Fall through */
 		case CMemory::MAP_PPU:
 			if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
 				return (OpenBus);
@@ -187,8 +222,8 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 	}
 
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*GetAddress = Memory.Map[block];
-	int32	speed = memory_speed(Address);
+	uint8	*GetAddress = Memory.Block[block].Map;
+	int32	speed = block_speed(block, Address);
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
@@ -206,6 +241,30 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 			addCyclesInMemoryAccess;
 			return (word);
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_NMI:
+			if ((Address & 0xffff) == 0xffea)
+			{
+				word = 0x2c00;
+				Memory.DisarmREXNMIHook();
+			}
+			else
+				word = READ_WORD(Memory.REXNMIBlock + (Address & 0xffff));
+			addCyclesInMemoryAccess_x2;
+			return (word);
+
+		case CMemory::MAP_REX_2C00:
+			if ((Address & 0xfe00) == 0x2c00 && (Address & 0x1ff) != 0x1ff)
+			{
+				word = READ_WORD(Memory.REX_2C00 + (Address & 0x1ff));
+				addCyclesInMemoryAccess_x2;
+				return (word);
+			}
+
+			word = OpenBus = S9xGetByte(Address);
+			return (word | (S9xGetByte(Address + 1) << 8));
+	#endif
+
 		case CMemory::MAP_PPU:
 			if (CPU.InDMAorHDMA)
 			{
@@ -320,8 +379,8 @@ inline uint16 S9xGetWord (uint32 Address, enum s9xwrap_t w = WRAP_NONE)
 inline void S9xSetByte (uint8 Byte, uint32 Address)
 {
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*SetAddress = Memory.WriteMap[block];
-	int32	speed = memory_speed(Address);
+	uint8	*SetAddress = Memory.Block[block].WriteMap;
+	int32	speed = block_speed(block, Address);
 
 	if (SetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
@@ -337,6 +396,16 @@ inline void S9xSetByte (uint8 Byte, uint32 Address)
 			addCyclesInMemoryAccess;
 			return;
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_2C00:
+			if ((Address & 0xfe00) == 0x2c00)
+			{
+				Memory.REX_2C00[Address & 0x1ff] = Byte;
+				addCyclesInMemoryAccess;
+				return;
+			}
+	#endif
+			/* Fall through */
 		case CMemory::MAP_PPU:
 			if (CPU.InDMAorHDMA && (Address & 0xff00) == 0x2100)
 				return;
@@ -460,8 +529,8 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 	}
 
 	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
-	uint8	*SetAddress = Memory.WriteMap[block];
-	int32	speed = memory_speed(Address);
+	uint8	*SetAddress = Memory.Block[block].WriteMap;
+	int32	speed = block_speed(block, Address);
 
 	if (SetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
@@ -490,6 +559,28 @@ inline void S9xSetWord (uint16 Word, uint32 Address, enum s9xwrap_t w = WRAP_NON
 				return;
 			}
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_2C00:
+			if ((Address & 0xfe00) == 0x2c00 && (Address & 0x1ff) != 0x1ff)
+			{
+				WRITE_WORD(Memory.REX_2C00 + (Address & 0x1ff), Word);
+				addCyclesInMemoryAccess_x2;
+				return;
+			}
+
+			if (o)
+			{
+				S9xSetByte(Word >> 8, Address + 1);
+				S9xSetByte((uint8) Word, Address);
+			}
+			else
+			{
+				S9xSetByte((uint8) Word, Address);
+				S9xSetByte(Word >> 8, Address + 1);
+			}
+			return;
+	#endif
+
 		case CMemory::MAP_PPU:
 			if (CPU.InDMAorHDMA)
 			{
@@ -699,9 +790,10 @@ inline void S9xSetPCBase (uint32 Address)
 	Registers.PBPC = Address & 0xffffff;
 	ICPU.ShiftedPB = Address & 0xff0000;
 
-	uint8	*GetAddress = Memory.Map[(int)((Address & 0xffffff) >> MEMMAP_SHIFT)];
+	int		block = (Address & 0xffffff) >> MEMMAP_SHIFT;
+	uint8	*GetAddress = Memory.Block[block].Map;
 
-	CPU.MemSpeed = memory_speed(Address);
+	CPU.MemSpeed = block_speed(block, Address);
 	CPU.MemSpeedx2 = CPU.MemSpeed << 1;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
@@ -757,6 +849,12 @@ inline void S9xSetPCBase (uint32 Address)
 			CPU.PCBase = S9xGetBasePointerBSX(Address);
 			return;
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_NMI:
+			CPU.PCBase = Memory.REXNMIBlock;
+			return;
+	#endif
+
 		case CMemory::MAP_NONE:
 		default:
 			CPU.PCBase = NULL;
@@ -766,7 +864,7 @@ inline void S9xSetPCBase (uint32 Address)
 
 inline uint8 * S9xGetBasePointer (uint32 Address)
 {
-	uint8	*GetAddress = Memory.Map[(Address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8	*GetAddress = Memory.Block[(Address & 0xffffff) >> MEMMAP_SHIFT].Map;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 		return (GetAddress);
@@ -803,6 +901,11 @@ inline uint8 * S9xGetBasePointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetBasePointerOBC1(Address & 0xffff));
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_NMI:
+			return (Memory.REXNMIBlock);
+	#endif
+
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
@@ -811,7 +914,7 @@ inline uint8 * S9xGetBasePointer (uint32 Address)
 
 inline uint8 * S9xGetMemPointer (uint32 Address)
 {
-	uint8	*GetAddress = Memory.Map[(Address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8	*GetAddress = Memory.Block[(Address & 0xffffff) >> MEMMAP_SHIFT].Map;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 		return (GetAddress + (Address & 0xffff));
@@ -848,6 +951,11 @@ inline uint8 * S9xGetMemPointer (uint32 Address)
 		case CMemory::MAP_OBC_RAM:
 			return (S9xGetMemPointerOBC1(Address & 0xffff));
 
+	#ifdef USE_REX
+		case CMemory::MAP_REX_NMI:
+			return (Memory.REXNMIBlock + (Address & 0xffff));
+	#endif
+
 		case CMemory::MAP_NONE:
 		default:
 			return (NULL);
@@ -14,9 +14,8 @@
 #include "screenshot.h"
 #include "display.h"
 
-extern struct SCheatData		Cheat;
-extern struct SLineData			LineData[240];
-extern struct SLineMatrixData	LineMatrixData[240];
+extern S9X_TLS struct SLineData			LineData[240];
+extern S9X_TLS struct SLineMatrixData	LineMatrixData[240];
 
 void S9xComputeClipWindows (void);
 
@@ -36,6 +35,9 @@ static void DrawBackgroundOffsetMosaic (int, uint8, uint8, int);
 static inline void DrawBackgroundMode7 (int, void (*DrawMath) (uint32, uint32, int), void (*DrawNomath) (uint32, uint32, int), int);
 static inline void DrawBackdrop (void);
 static inline void RenderScreen (bool8);
+#ifdef S9X_THREADED_RENDER
+static void RenderBatch (void);
+#endif
 static uint16 get_crosshair_color (uint8);
 static void S9xDisplayStringType (const char *, int, int, bool, int);
 
@@ -48,6 +50,8 @@ bool8 S9xGraphicsInit (void)
 	memset(BlackColourMap, 0, 256 * sizeof(uint16));
 
 	IPPU.OBJChanged = TRUE;
+	IPPU.OBJDirty[0] = IPPU.OBJDirty[1] = ~(uint64) 0;
+	GFX.OBJSetup = ~0u;
 	Settings.BG_Forced = 0;
 	Settings.ForcedBackdrop = 0;
 	S9xFixColourBrightness();
@@ -56,11 +60,19 @@ bool8 S9xGraphicsInit (void)
 	GFX.ScreenBuffer.resize(MAX_SNES_WIDTH * (MAX_SNES_HEIGHT + 64));
 	GFX.Screen = &GFX.ScreenBuffer[GFX.RealPPL * 32];
 	GFX.ZERO = (uint16 *) malloc(sizeof(uint16) * 0x10000);
-	GFX.SubScreen  = (uint16 *) malloc(GFX.ScreenSize * sizeof(uint16));
-	GFX.ZBuffer    = (uint8 *)  malloc(GFX.ScreenSize);
-	GFX.SubZBuffer = (uint8 *)  malloc(GFX.ScreenSize);
+	// zeroed, as the first frame may start part way down with no refresh to clear them
+	GFX.SubScreen  = (uint16 *) calloc(GFX.ScreenSize, sizeof(uint16));
+	GFX.ZBuffer    = (uint8 *)  calloc(GFX.ScreenSize, 1);
+	GFX.SubZBuffer = (uint8 *)  calloc(GFX.ScreenSize, 1);
+#ifdef S9X_SIMD
+	GFX.MathTag    = (uint8 *)  malloc(GFX.ScreenSize);
+#endif
 
-	if (!GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer)
+	if (!GFX.ZERO || !GFX.SubScreen || !GFX.ZBuffer || !GFX.SubZBuffer
+	#ifdef S9X_SIMD
+		|| !GFX.MathTag
+	#endif
+		)
 	{
 		S9xGraphicsDeinit();
 		return (FALSE);
@@ -103,10 +115,17 @@ bool8 S9xGraphicsInit (void)
 
 void S9xGraphicsDeinit (void)
 {
+#ifdef S9X_THREADED_RENDER
+	S9xRenderThreadStop();
+#endif
+
 	if (GFX.ZERO)       { free(GFX.ZERO);       GFX.ZERO       = NULL; }
 	if (GFX.SubScreen)  { free(GFX.SubScreen);  GFX.SubScreen  = NULL; }
 	if (GFX.ZBuffer)    { free(GFX.ZBuffer);    GFX.ZBuffer    = NULL; }
 	if (GFX.SubZBuffer) { free(GFX.SubZBuffer); GFX.SubZBuffer = NULL; }
+#ifdef S9X_SIMD
+	if (GFX.MathTag)    { free(GFX.MathTag);    GFX.MathTag    = NULL; }
+#endif
 }
 
 void S9xGraphicsScreenResize (void)
@@ -178,6 +197,10 @@ void S9xStartScreenRefresh (void)
 
 		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
 		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+
+	#ifdef S9X_THREADED_RENDER
+		S9xRenderThreadNewFrame();
+	#endif
 	}
 
 	if (++IPPU.FrameCount == (uint32)Memory.ROMFramesPerSecond)
@@ -198,6 +221,9 @@ void S9xEndScreenRefresh (void)
 	if (IPPU.RenderThisFrame)
 	{
 		FLUSH_REDRAW();
+	#ifdef S9X_THREADED_RENDER
+		S9xRenderThreadSync();
+	#endif
 
 		if (GFX.DoInterlace && S9xInterlaceField() == 0)
 		{
@@ -294,6 +320,11 @@ void RenderLine (uint8 C)
 		}
 
 		IPPU.CurrentLine = C + 1;
+
+	#ifdef S9X_THREADED_RENDER
+		if (IPPU.CurrentLine - IPPU.PreviousLine >= RENDER_THREAD_BATCH && S9xRenderThreadActive())
+			RenderBatch();
+	#endif
 	}
 	else
 	{
@@ -305,6 +336,25 @@ void RenderLine (uint8 C)
 	}
 }
 
+#ifdef S9X_THREADED_RENDER
+// Hands the lines so far to the render thread without waiting for a register write, so drawing overlaps the rest of
+// the frame. Range time over is collected at flushes, so it is put back as if there had been none. Under mosaic the
+// start of a range decides which line's scroll a block uses, so there the batches are left to the flushes.
+static void RenderBatch (void)
+{
+	if (PPU.Mosaic > 1 && (PPU.BGMosaic[0] || PPU.BGMosaic[1] || PPU.BGMosaic[2] || PPU.BGMosaic[3]))
+		return;
+
+	uint8	rto = PPU.RangeTimeOver;
+	uint32	endy = GFX.EndY;
+
+	S9xUpdateScreen();
+
+	PPU.RangeTimeOver = rto;
+	GFX.EndY = endy;
+}
+#endif
+
 static inline void RenderScreen (bool8 sub)
 {
 	uint8	BGActive;
@@ -350,6 +400,7 @@ static inline void RenderScreen (bool8 sub)
 			BG.EnableMath = !sub && (Memory.FillRAM[0x2131] & (1 << n)); \
 			BG.TileSizeH = (!hires && PPU.BG[n].BGSize) ? 16 : 8; \
 			BG.TileSizeV = (PPU.BG[n].BGSize) ? 16 : 8; \
+			BG.TileAddress = PPU.BG[n].NameBase << 1; \
 			S9xSelectTileConverter(depth, hires, sub, PPU.BGMosaic[n]); \
 			\
 			if (offset) \
@@ -435,6 +486,13 @@ static inline void RenderScreen (bool8 sub)
 
 void S9xUpdateScreen (void)
 {
+#ifdef S9X_THREADED_RENDER
+	// the render thread takes the state as it is now and draws these lines from its copy; this keeps the rest in step
+	const bool8	draw = !S9xRenderThreadQueue();
+#else
+	const bool8	draw = TRUE;
+#endif
+
 	if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
 		SetupOBJ();
 
@@ -452,14 +510,15 @@ void S9xUpdateScreen (void)
 
 		if (PPU.RecomputeClipWindows)
 		{
-			S9xComputeClipWindows();
+			if (draw)
+				S9xComputeClipWindows();
 			PPU.RecomputeClipWindows = FALSE;
 		}
 
 		if (!IPPU.DoubleWidthPixels && (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires))
 		{
 			// Have to back out of the regular speed hack
-			for (uint32 y = 0; y < GFX.StartY; y++)
+			for (uint32 y = 0; draw && y < GFX.StartY; y++)
 			{
 				uint16	*p = GFX.Screen + y * GFX.PPL + 255;
 				uint16	*q = GFX.Screen + y * GFX.PPL + 510;
@@ -479,22 +538,32 @@ void S9xUpdateScreen (void)
 			GFX.PPL = GFX.RealPPL << 1;
 			GFX.DoInterlace = 2;
 
-			for (int32 y = (int32) GFX.StartY - 2; y >= 0; y--)
+			for (int32 y = (int32) GFX.StartY - 2; draw && y >= 0; y--)
 				memmove(GFX.Screen + (y + 1) * GFX.PPL, GFX.Screen + y * GFX.RealPPL, GFX.PPL * sizeof(uint16));
 		}
 
-		if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
-			GFX.FixedColour = BUILD_PIXEL(IPPU.XB[PPU.FixedColourRed], IPPU.XB[PPU.FixedColourGreen], IPPU.XB[PPU.FixedColourBlue]);
-
-		if (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
-			((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f)))
-			// If hires (Mode 5/6 or pseudo-hires) or math is to be done
-			// involving the subscreen, then we need to render the subscreen...
-			RenderScreen(TRUE);
-
-		RenderScreen(FALSE);
+		if (draw)
+		{
+			if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
+				GFX.FixedColour = BUILD_PIXEL(IPPU.XB[PPU.FixedColourRed], IPPU.XB[PPU.FixedColourGreen], IPPU.XB[PPU.FixedColourBlue]);
+
+			if (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
+				((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f)))
+				// If hires (Mode 5/6 or pseudo-hires) or math is to be done
+				// involving the subscreen, then we need to render the subscreen...
+				RenderScreen(TRUE);
+
+		#ifdef S9X_SIMD
+			S9xStartColourMath();
+		#endif
+			RenderScreen(FALSE);
+		#ifdef S9X_SIMD
+			S9xApplyColourMath();
+		#endif
+		}
 	}
 	else
+	if (draw)
 	{
 		const uint16	black = BUILD_PIXEL(0, 0, 0);
 
@@ -510,6 +579,58 @@ void S9xUpdateScreen (void)
 	IPPU.PreviousLine = IPPU.CurrentLine;
 }
 
+// Lists the sprites on line Y in the order they are drawn in, from FirstSprite on, up to the sprite limit.
+static void ListOBJLine (int Y, int sprite_limit, int startline, int inc)
+{
+	uint8	FirstSprite = PPU.FirstSprite;
+	uint32	w = FirstSprite >> 6;
+	uint64	from = ~(uint64) 0 << (FirstSprite & 63);
+	uint64	chunks[3] = { GFX.OBJOnLine[Y][w] & from, GFX.OBJOnLine[Y][w ^ 1], GFX.OBJOnLine[Y][w] & ~from };
+	uint32	bases[3] = { w << 6, (w ^ 1) << 6, w << 6 };
+	uint8	flags = 0;
+	int16	tiles = Settings.MaxSpriteTilesPerLine;
+	int		j = 0;
+
+	for (int c = 0; c < 3 && !(flags & 0x40); c++)
+	{
+		uint64	bits = chunks[c];
+
+		for (uint32 S = bases[c]; bits; S++, bits >>= 1)
+		{
+			if (!(bits & 1))
+				continue;
+
+			if (j >= sprite_limit)
+			{
+				flags |= 0x40;
+				break;
+			}
+
+			tiles -= GFX.OBJVisibleTiles[S];
+			if (tiles < 0)
+				flags |= 0x80;
+
+			uint8	line = startline + ((Y - GFX.OBJFirstLine[S]) & 0xff) * inc;
+
+			GFX.OBJLines[Y].OBJ[j].Sprite = S;
+			if (PPU.OBJ[S].VFlip)
+				// Yes, Width not Height. It so happens that the
+				// sprites with H=2*W flip as two WxW sprites.
+				GFX.OBJLines[Y].OBJ[j].Line = line ^ (GFX.OBJWidths[S] - 1);
+			else
+				GFX.OBJLines[Y].OBJ[j].Line = line;
+
+			j++;
+		}
+	}
+
+	if (j < sprite_limit)
+		GFX.OBJLines[Y].OBJ[j].Sprite = -1;
+
+	GFX.OBJLines[Y].Tiles = tiles;
+	GFX.OBJLineFlags[Y] = flags;
+}
+
 static void SetupOBJ (void)
 {
 	int	SmallWidth, SmallHeight, LargeWidth, LargeHeight;
@@ -572,78 +693,90 @@ static void SetupOBJ (void)
 
 	if (!PPU.OAMPriorityRotation || !(PPU.OAMFlip & PPU.OAMAddr & 1)) // normal case
 	{
-		uint8	LineOBJ[SNES_HEIGHT_EXTENDED];
-		memset(LineOBJ, 0, sizeof(LineOBJ));
+		// Sprites are only taken off and put back on the lines they cover when OAM writes have changed them, and only
+		// the lines that gained or lost one are listed again. A new size, interlace field or tile limit places them all.
+		uint32	setup = PPU.OBJSizeSelect | (startline << 3) | (inc << 4) | (Settings.MaxSpriteTilesPerLine << 8);
+		uint64	LineDirty[(SNES_HEIGHT_EXTENDED + 63) / 64];
+		bool8	all = GFX.OBJSetup != setup || GFX.OBJFirstSprite != PPU.FirstSprite;	// FirstSprite reorders every line
 
-		for (int i = 0; i < SNES_HEIGHT_EXTENDED; i++)
+		if (GFX.OBJSetup != setup)
 		{
-			GFX.OBJLines[i].RTOFlags = 0;
-			GFX.OBJLines[i].Tiles = Settings.MaxSpriteTilesPerLine;
-			for (int j = 0; j < sprite_limit; j++)
-				GFX.OBJLines[i].OBJ[j].Sprite = -1;
+			memset(GFX.OBJOnLine, 0, sizeof(GFX.OBJOnLine));
+			memset(GFX.OBJLineCount, 0, sizeof(GFX.OBJLineCount));
+			IPPU.OBJDirty[0] = IPPU.OBJDirty[1] = ~(uint64) 0;
+			GFX.OBJSetup = setup;
 		}
 
-		uint8	FirstSprite = PPU.FirstSprite;
-		S = FirstSprite;
+		memset(LineDirty, all ? 0xff : 0, sizeof(LineDirty));
+		GFX.OBJFirstSprite = PPU.FirstSprite;
 
-		do
+		for (int w = 0; w < 2; w++)
 		{
-			if (PPU.OBJ[S].Size)
-			{
-				GFX.OBJWidths[S] = LargeWidth;
-				Height = LargeHeight;
-			}
-			else
-			{
-				GFX.OBJWidths[S] = SmallWidth;
-				Height = SmallHeight;
-			}
+			uint64	bits = IPPU.OBJDirty[w];
 
-			int	HPos = PPU.OBJ[S].HPos;
-			if (HPos == -256)
-				HPos = 0;
+			IPPU.OBJDirty[w] = 0;
 
-			if (HPos > -GFX.OBJWidths[S] && HPos <= 256)
+			for (S = w << 6; bits; S++, bits >>= 1)
 			{
-				if (HPos < 0)
-					GFX.OBJVisibleTiles[S] = (GFX.OBJWidths[S] + HPos + 7) >> 3;
-				else if (HPos + GFX.OBJWidths[S] > 255)
-					GFX.OBJVisibleTiles[S] = (256 - HPos + 7) >> 3;
-				else
-					GFX.OBJVisibleTiles[S] = GFX.OBJWidths[S] >> 3;
+				if (!(bits & 1))
+					continue;
 
-				for (uint8 line = startline, Y = (uint8) (PPU.OBJ[S].VPos & 0xff); line < Height; Y++, line += inc)
+				for (uint8 n = 0, Y = GFX.OBJFirstLine[S]; n < GFX.OBJLineCount[S]; n++, Y++)
 				{
 					if (Y >= SNES_HEIGHT_EXTENDED)
 						continue;
 
-					if (LineOBJ[Y] >= sprite_limit)
-					{
-						GFX.OBJLines[Y].RTOFlags |= 0x40;
-						continue;
-					}
+					GFX.OBJOnLine[Y][S >> 6] &= ~((uint64) 1 << (S & 63));
+					LineDirty[Y >> 6] |= (uint64) 1 << (Y & 63);
+				}
 
-					GFX.OBJLines[Y].Tiles -= GFX.OBJVisibleTiles[S];
-					if (GFX.OBJLines[Y].Tiles < 0)
-						GFX.OBJLines[Y].RTOFlags |= 0x80;
+				GFX.OBJLineCount[S] = 0;
 
-					GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Sprite = S;
-					if (PPU.OBJ[S].VFlip)
-						// Yes, Width not Height. It so happens that the
-						// sprites with H=2*W flip as two WxW sprites.
-						GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Line = line ^ (GFX.OBJWidths[S] - 1);
+				if (PPU.OBJ[S].Size)
+				{
+					GFX.OBJWidths[S] = LargeWidth;
+					Height = LargeHeight;
+				}
+				else
+				{
+					GFX.OBJWidths[S] = SmallWidth;
+					Height = SmallHeight;
+				}
+
+				int	HPos = PPU.OBJ[S].HPos;
+				if (HPos == -256)
+					HPos = 0;
+
+				if (HPos > -GFX.OBJWidths[S] && HPos <= 256)
+				{
+					if (HPos < 0)
+						GFX.OBJVisibleTiles[S] = (GFX.OBJWidths[S] + HPos + 7) >> 3;
+					else if (HPos + GFX.OBJWidths[S] > 255)
+						GFX.OBJVisibleTiles[S] = (256 - HPos + 7) >> 3;
 					else
-						GFX.OBJLines[Y].OBJ[LineOBJ[Y]].Line = line;
+						GFX.OBJVisibleTiles[S] = GFX.OBJWidths[S] >> 3;
+
+					GFX.OBJFirstLine[S] = (uint8) (PPU.OBJ[S].VPos & 0xff);
 
-					LineOBJ[Y]++;
+					for (uint8 line = startline, Y = GFX.OBJFirstLine[S]; line < Height; Y++, line += inc, GFX.OBJLineCount[S]++)
+					{
+						if (Y >= SNES_HEIGHT_EXTENDED)
+							continue;
+
+						GFX.OBJOnLine[Y][S >> 6] |= (uint64) 1 << (S & 63);
+						LineDirty[Y >> 6] |= (uint64) 1 << (Y & 63);
+					}
 				}
 			}
+		}
 
-			S = (S + 1) & 0x7f;
-		} while (S != FirstSprite);
+		for (int Y = 0; Y < SNES_HEIGHT_EXTENDED; Y++)
+		{
+			if (LineDirty[Y >> 6] & ((uint64) 1 << (Y & 63)))
+				ListOBJLine(Y, sprite_limit, startline, inc);
 
-		for (int Y = 1; Y < SNES_HEIGHT_EXTENDED; Y++)
-			GFX.OBJLines[Y].RTOFlags |= GFX.OBJLines[Y - 1].RTOFlags;
+			GFX.OBJLines[Y].RTOFlags = GFX.OBJLineFlags[Y] | (Y ? GFX.OBJLines[Y - 1].RTOFlags : 0);
+		}
 	}
 	else // evil FirstSprite+Y case
 	{
@@ -740,6 +873,9 @@ static void SetupOBJ (void)
 			if (j < sprite_limit)
 				GFX.OBJLines[Y].OBJ[j].Sprite = -1;
 		}
+
+		// the normal case has to place every sprite again after this
+		GFX.OBJSetup = ~0u;
 	}
 
 	IPPU.OBJChanged = FALSE;
@@ -848,8 +984,6 @@ static void DrawOBJS (int D)
 
 static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 {
-	BG.TileAddress = PPU.BG[bg].NameBase << 1;
-
 	uint32	Tile;
 	uint16	*SC0, *SC1, *SC2, *SC3;
 
@@ -1065,8 +1199,6 @@ static void DrawBackground (int bg, uint8 Zh, uint8 Zl)
 
 static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
 {
-	BG.TileAddress = PPU.BG[bg].NameBase << 1;
-
 	uint32	Tile;
 	uint16	*SC0, *SC1, *SC2, *SC3;
 
@@ -1231,8 +1363,6 @@ static void DrawBackgroundMosaic (int bg, uint8 Zh, uint8 Zl)
 
 static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 {
-	BG.TileAddress = PPU.BG[bg].NameBase << 1;
-
 	uint32	Tile;
 	uint16	*SC0, *SC1, *SC2, *SC3;
 	uint16	*BPS0, *BPS1, *BPS2, *BPS3;
@@ -1459,8 +1589,6 @@ static void DrawBackgroundOffset (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 
 static void DrawBackgroundOffsetMosaic (int bg, uint8 Zh, uint8 Zl, int VOffOff)
 {
-	BG.TileAddress = PPU.BG[bg].NameBase << 1;
-
 	uint32	Tile;
 	uint16	*SC0, *SC1, *SC2, *SC3;
 	uint16	*BPS0, *BPS1, *BPS2, *BPS3;
@@ -1864,13 +1992,7 @@ void S9xVariableDisplayString(const char* string, int linesFromBottom,	int pixel
 
 static void DisplayStringFromBottom(const char* string, int linesFromBottom, int pixelsFromLeft, bool allowWrap)
 {
-	if (S9xCustomDisplayString)
-	{
-		S9xCustomDisplayString(string, linesFromBottom, pixelsFromLeft, allowWrap, S9X_NO_INFO);
-		return;
-	}
-
-	S9xVariableDisplayString(string, linesFromBottom, pixelsFromLeft, allowWrap, S9X_NO_INFO);
+	S9xDisplayStringType(string, linesFromBottom, pixelsFromLeft, allowWrap, S9X_NO_INFO);
 }
 
 static void S9xDisplayStringType(const char* string, int linesFromBottom, int pixelsFromLeft, bool allowWrap, int type)
@@ -1901,8 +2023,8 @@ static void DisplayTime (void)
 static void DisplayFrameRate (void)
 {
 	char	string[10];
-	static uint32 lastFrameCount = 0, calcFps = 0;
-	static time_t lastTime = time(NULL);
+	static S9X_TLS uint32 lastFrameCount = 0, calcFps = 0;
+	static S9X_TLS time_t lastTime = time(NULL);
 
 	time_t currTime = time(NULL);
 	if (lastTime != currTime) {
@@ -20,6 +20,9 @@ struct SGFX
 	uint16	*SubScreen;
 	uint8	*ZBuffer;
 	uint8	*SubZBuffer;
+#ifdef S9X_SIMD
+	uint8	*MathTag;			// main screen colour math left for S9xApplyColourMath: 0 none, 1 math, 2 math on a clipped pixel
+#endif
 	uint16	*S;
 	uint8	*DB;
 	uint16	*ZERO;
@@ -51,6 +54,14 @@ struct SGFX
 		}	OBJ[128];
 	}	OBJLines[SNES_HEIGHT_EXTENDED];
 
+	// what SetupOBJ keeps between calls, so that it only places the sprites that changed and lists their lines again
+	uint64	OBJOnLine[SNES_HEIGHT_EXTENDED][2];	// the sprites on each line, before the sprite limit
+	uint8	OBJLineFlags[SNES_HEIGHT_EXTENDED];	// range and time over on each line itself, not carried from above
+	uint8	OBJFirstLine[128];
+	uint8	OBJLineCount[128];
+	uint32	OBJSetup;							// the sizes, interlace field and tile limit the above were made for
+	uint8	OBJFirstSprite;
+
 	void	(*DrawBackdropMath) (uint32, uint32, uint32);
 	void	(*DrawBackdropNomath) (uint32, uint32, uint32);
 	void	(*DrawTileMath) (uint32, uint32, uint32, uint32);
@@ -71,9 +82,6 @@ struct SGFX
 
 struct SBG
 {
-	uint8	(*ConvertTile) (uint8 *, uint32, uint32);
-	uint8	(*ConvertTileFlip) (uint8 *, uint32, uint32);
-
 	uint32	TileSizeH;
 	uint32	TileSizeV;
 	uint32	OffsetSizeH;
@@ -117,12 +125,12 @@ struct SLineMatrixData
 	short	M7VOFS;
 };
 
-extern uint16		BlackColourMap[256];
-extern uint16		DirectColourMaps[8][256];
+extern S9X_TLS uint16		BlackColourMap[256];
+extern S9X_TLS uint16		DirectColourMaps[8][256];
 extern uint8		mul_brightness[16][32];
-extern uint8		brightness_cap[64];
-extern struct SBG	BG;
-extern struct SGFX	GFX;
+extern S9X_TLS uint8		brightness_cap[64];
+extern S9X_TLS struct SBG	BG;
+extern S9X_TLS struct SGFX	GFX;
 
 #define H_FLIP		0x4000
 #define V_FLIP		0x8000
@@ -156,26 +164,6 @@ struct COLOR_ADD
 	}
 };
 
-struct COLOR_ADD_BRIGHTNESS
-{
-	static alwaysinline uint16 fn(uint16 C1, uint16 C2)
-	{
-		return ((brightness_cap[ (C1 >> RED_SHIFT_BITS)           +  (C2 >> RED_SHIFT_BITS)          ] << RED_SHIFT_BITS)   |
-				(brightness_cap[((C1 >> GREEN_SHIFT_BITS) & 0x1f) + ((C2 >> GREEN_SHIFT_BITS) & 0x1f)] << GREEN_SHIFT_BITS) |
-	// Proper 15->16bit color conversion moves the high bit of green into the low bit.
-	#if GREEN_SHIFT_BITS == 6
-			   ((brightness_cap[((C1 >> 6) & 0x1f) + ((C2 >> 6) & 0x1f)] & 0x10) << 1) |
-	#endif
-				(brightness_cap[ (C1                      & 0x1f) +  (C2                      & 0x1f)]      ));
-	}
-
-	static alwaysinline uint16 fn1_2(uint16 C1, uint16 C2)
-	{
-		return COLOR_ADD::fn1_2(C1, C2);
-	}
-};
-
-
 struct COLOR_SUB
 {
 	static alwaysinline uint16 fn(uint16 C1, uint16 C2)
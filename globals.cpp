@@ -20,57 +20,57 @@
 #include "missing.h"
 #endif
 
-struct SCPUState		CPU;
-struct SICPU			ICPU;
-struct SRegisters		Registers;
-struct SPPU				PPU;
-struct InternalPPU		IPPU;
-struct SDMA				DMA[8];
-struct STimings			Timings;
-struct SGFX				GFX;
-struct SBG				BG;
-struct SLineData		LineData[240];
-struct SLineMatrixData	LineMatrixData[240];
-struct SDSP0			DSP0;
-struct SDSP1			DSP1;
-struct SDSP2			DSP2;
-struct SDSP3			DSP3;
-struct SDSP4			DSP4;
-struct SSA1				SA1;
-struct SSA1Registers	SA1Registers;
-struct FxRegs_s			GSU;
-struct FxInfo_s			SuperFX;
-struct SST010			ST010;
-struct SST011			ST011;
-struct SST018			ST018;
-struct SOBC1			OBC1;
-struct SSPC7110Snapshot	s7snap;
-struct SSRTCSnapshot	srtcsnap;
-struct SRTCData			RTCData;
-struct SBSX				BSX;
-struct SMSU1			MSU1;
-struct SMulti			Multi;
-struct SSettings		Settings;
-struct SSNESGameFixes	SNESGameFixes;
+S9X_TLS struct SCPUState		CPU;
+S9X_TLS struct SICPU			ICPU;
+S9X_TLS struct SRegisters		Registers;
+S9X_TLS struct SPPU				PPU;
+S9X_TLS struct InternalPPU		IPPU;
+S9X_TLS struct SDMA				DMA[8];
+S9X_TLS struct STimings			Timings;
+S9X_TLS struct SGFX				GFX;
+S9X_TLS struct SBG				BG;
+S9X_TLS struct SLineData		LineData[240];
+S9X_TLS struct SLineMatrixData	LineMatrixData[240];
+S9X_TLS struct SDSP0			DSP0;
+S9X_TLS struct SDSP1			DSP1;
+S9X_TLS struct SDSP2			DSP2;
+S9X_TLS struct SDSP3			DSP3;
+S9X_TLS struct SDSP4			DSP4;
+S9X_TLS struct SSA1				SA1;
+S9X_TLS struct SSA1Registers	SA1Registers;
+S9X_TLS struct FxRegs_s			GSU;
+S9X_TLS struct FxInfo_s			SuperFX;
+S9X_TLS struct SST010			ST010;
+S9X_TLS struct SST011			ST011;
+S9X_TLS struct SST018			ST018;
+S9X_TLS struct SOBC1			OBC1;
+S9X_TLS struct SSPC7110Snapshot	s7snap;
+S9X_TLS struct SSRTCSnapshot	srtcsnap;
+S9X_TLS struct SRTCData			RTCData;
+S9X_TLS struct SBSX				BSX;
+S9X_TLS struct SMSU1			MSU1;
+S9X_TLS struct SMulti			Multi;
+S9X_TLS struct SSettings		Settings;
+S9X_TLS struct SSNESGameFixes	SNESGameFixes;
 #ifdef NETPLAY_SUPPORT
-struct SNetPlay			NetPlay;
+S9X_TLS struct SNetPlay			NetPlay;
 #endif
 #ifdef DEBUGGER
-struct Missing			missing;
+S9X_TLS struct Missing			missing;
 #endif
-struct SCheatData		Cheat;
-struct Watch			watches[16];
-CMemory					Memory;
+S9X_TLS struct SCheatData		Cheat;
+S9X_TLS struct Watch			watches[16];
+S9X_TLS CMemory					Memory;
 
-char	String[513];
-uint8	OpenBus = 0;
-uint8	*HDMAMemPointers[8];
-uint16	BlackColourMap[256];
-uint16	DirectColourMaps[8][256];
+S9X_TLS char	String[513];
+S9X_TLS uint8	OpenBus = 0;
+S9X_TLS uint8	*HDMAMemPointers[8];
+S9X_TLS uint16	BlackColourMap[256];
+S9X_TLS uint16	DirectColourMaps[8][256];
 
 SnesModel	M1SNES = { 1, 3, 2 };
 SnesModel	M2SNES = { 2, 4, 3 };
-SnesModel	*Model = &M1SNES;
+S9X_TLS SnesModel	*Model = &M1SNES;
 
 uint16 SignExtend[2] =
 {
@@ -119,7 +119,7 @@ uint8 mul_brightness[16][32] =
 	  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f }
 };
 
-uint8 brightness_cap[64];
+S9X_TLS uint8 brightness_cap[64];
 
 uint8 S9xOpLengthsM0X0[256] =
 {
@@ -160,6 +160,7 @@ int Snes9xConfig::load_defaults()
     Settings.UpAndDown = false;
     Settings.AutoSaveDelay = 0;
     Settings.SkipFrames = 0;
+    Settings.RunAheadFrames = 0;
     Settings.Transparency = true;
     Settings.DisplayTime = false;
     Settings.DisplayFrameRate = false;
@@ -318,6 +319,7 @@ int Snes9xConfig::save_config_file()
     outbool("DisplayPressedKeys", Settings.DisplayPressedKeys);
     outbool("DisplayIndicators", Settings.DisplayIndicators);
     outint("SpeedControlMethod", Settings.SkipFrames, "0: Time the frames to 50 or 60Hz, 1: Same, but skip frames if too slow, 2: Synchronize to the sound buffer, 3: Unlimited, except potentially by vsync");
+    outint("RunAheadFrames", Settings.RunAheadFrames, "Show this many frames ahead to hide the game's own input lag");
     outint("SaveSRAMEveryNSeconds", Settings.AutoSaveDelay);
     outbool("BlockInvalidVRAMAccess", Settings.BlockInvalidVRAMAccessMaster);
     outbool("AllowDPadContradictions", Settings.UpAndDown, "Allow the D-Pad to press both up + down at the same time, or left + right");
@@ -540,6 +542,7 @@ int Snes9xConfig::load_config_file()
     inbool("DisplayFrameRate", Settings.DisplayFrameRate);
     inbool("DisplayPressedKeys", Settings.DisplayPressedKeys);
     inint("SpeedControlMethod", Settings.SkipFrames);
+    inint("RunAheadFrames", Settings.RunAheadFrames);
     inint("SaveSRAMEveryNSeconds", Settings.AutoSaveDelay);
     inbool("BlockInvalidVRAMAccess", Settings.BlockInvalidVRAMAccessMaster);
     inbool("AllowDPadContradictions", Settings.UpAndDown);
@@ -654,6 +657,7 @@ int Snes9xConfig::load_config_file()
     hires_effect = CLAMP(hires_effect, 0, 2);
     Settings.DynamicRateLimit = CLAMP(Settings.DynamicRateLimit, 1, 1000);
     Settings.SuperFXClockMultiplier = CLAMP(Settings.SuperFXClockMultiplier, 50, 400);
+    Settings.RunAheadFrames = MIN(Settings.RunAheadFrames, 4);
     ntsc_scanline_intensity = MIN(ntsc_scanline_intensity, 4);
     scanline_filter_intensity = MIN(scanline_filter_intensity, 3);
 
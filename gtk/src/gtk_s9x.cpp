@@ -341,7 +341,10 @@ static bool S9xIdleFunc()
         else
             Settings.Mute &= ~0x80;
 
-        S9xMainLoop();
+        if (Settings.RunAheadFrames)
+            S9xMainLoopRunAhead();
+        else
+            S9xMainLoop();
 
         S9xNetplayPop();
     }
@@ -14,6 +14,8 @@
 #include "display.h"
 #include "conffile.h"
 #include "crosshairs.h"
+#include "profiler.h"
+#include "renderthread.h"
 #include <stdio.h>
 #include <vector>
 #include <string>
@@ -34,8 +36,8 @@
 #define RETRO_DEVICE_LIGHTGUN_JUSTIFIER_2 ((3 << 8) | RETRO_DEVICE_LIGHTGUN)
 #define RETRO_DEVICE_LIGHTGUN_MACS_RIFLE ((4 << 8) | RETRO_DEVICE_LIGHTGUN)
 
-static int g_screen_gun_width = SNES_WIDTH;
-static int g_screen_gun_height = SNES_HEIGHT;
+static S9X_TLS int g_screen_gun_width = SNES_WIDTH;
+static S9X_TLS int g_screen_gun_height = SNES_HEIGHT;
 
 #define RETRO_MEMORY_SNES_BSX_RAM ((1 << 8) | RETRO_MEMORY_SAVE_RAM)
 #define RETRO_MEMORY_SNES_BSX_PRAM ((2 << 8) | RETRO_MEMORY_SAVE_RAM)
@@ -53,34 +55,34 @@ static int g_screen_gun_height = SNES_HEIGHT;
 
 #define SNES_4_3 4.0f / 3.0f
 
-uint16 *screen_buffer = NULL;
+S9X_TLS uint16 *screen_buffer = NULL;
 
-char g_rom_dir[1024];
-char g_basename[1024];
+S9X_TLS char g_rom_dir[1024];
+S9X_TLS char g_basename[1024];
 
-bool g_geometry_update = false;
+S9X_TLS bool g_geometry_update = false;
 
-int hires_blend = 0;
-bool randomize_memory = false;
+S9X_TLS int hires_blend = 0;
+S9X_TLS bool randomize_memory = false;
 
-char retro_system_directory[4096];
-char retro_save_directory[4096];
+S9X_TLS char retro_system_directory[4096];
+S9X_TLS char retro_save_directory[4096];
 
-retro_log_printf_t log_cb = NULL;
-static retro_video_refresh_t video_cb = NULL;
-static retro_audio_sample_t audio_cb = NULL;
-static retro_audio_sample_batch_t audio_batch_cb = NULL;
-static retro_input_poll_t poll_cb = NULL;
-static retro_input_state_t input_state_cb = NULL;
+S9X_TLS retro_log_printf_t log_cb = NULL;
+static S9X_TLS retro_video_refresh_t video_cb = NULL;
+static S9X_TLS retro_audio_sample_t audio_cb = NULL;
+static S9X_TLS retro_audio_sample_batch_t audio_batch_cb = NULL;
+static S9X_TLS retro_input_poll_t poll_cb = NULL;
+static S9X_TLS retro_input_state_t input_state_cb = NULL;
 
-static snes_ntsc_t *snes_ntsc = NULL;
-static int blargg_filter = 0;
-static uint16 *ntsc_screen_buffer, *snes_ntsc_buffer;
+static S9X_TLS snes_ntsc_t *snes_ntsc = NULL;
+static S9X_TLS int blargg_filter = 0;
+static S9X_TLS uint16 *ntsc_screen_buffer, *snes_ntsc_buffer;
 
 const int MAX_SNES_WIDTH_NTSC = ((SNES_NTSC_OUT_WIDTH(256) + 3) / 4) * 4;
 
-static bool show_lightgun_settings = true;
-static bool show_advanced_av_settings = true;
+static S9X_TLS bool show_lightgun_settings = true;
+static S9X_TLS bool show_advanced_av_settings = true;
 
 static void extract_basename(char *buf, const char *path, size_t size)
 {
@@ -154,26 +156,26 @@ enum aspect_mode {
     ASPECT_RATIO_PAL,
     ASPECT_RATIO_AUTO
 };
-static retro_environment_t environ_cb;
-static overscan_mode crop_overscan_mode = OVERSCAN_CROP_ON; // default to crop
-static aspect_mode aspect_ratio_mode = ASPECT_RATIO_4_3; // default to 4:3
-static bool rom_loaded = false;
+static S9X_TLS retro_environment_t environ_cb;
+static S9X_TLS overscan_mode crop_overscan_mode = OVERSCAN_CROP_ON; // default to crop
+static S9X_TLS aspect_mode aspect_ratio_mode = ASPECT_RATIO_4_3; // default to 4:3
+static S9X_TLS bool rom_loaded = false;
 
 enum lightgun_mode
 {
 	SETTING_GUN_INPUT_LIGHTGUN,
 	SETTING_GUN_INPUT_POINTER
 };
-static lightgun_mode setting_gun_input = SETTING_GUN_INPUT_LIGHTGUN;
+static S9X_TLS lightgun_mode setting_gun_input = SETTING_GUN_INPUT_LIGHTGUN;
 
 // Touchscreen sensitivity vars
-static int pointer_pressed = 0;
+static S9X_TLS int pointer_pressed = 0;
 static const int POINTER_PRESSED_CYCLES = 4;
-static int pointer_cycles_after_released = 0;
-static int pointer_pressed_last_x = 0;
-static int pointer_pressed_last_y = 0;
+static S9X_TLS int pointer_cycles_after_released = 0;
+static S9X_TLS int pointer_pressed_last_x = 0;
+static S9X_TLS int pointer_pressed_last_y = 0;
 
-static bool setting_superscope_reverse_buttons = false;
+static S9X_TLS bool setting_superscope_reverse_buttons = false;
 
 void retro_set_environment(retro_environment_t cb)
 {
@@ -303,6 +305,8 @@ void update_geometry(void)
     g_geometry_update = false;
 }
 
+static void latch_input();
+
 static void update_variables(void)
 {
     char key[256];
@@ -426,6 +430,54 @@ static void update_variables(void)
         if (strcmp(var.value, "enabled") == 0)
             Settings.MaxSpriteTilesPerLine = 128;
 
+    Settings.CPUBlockCache = FALSE;
+    var.key="snes9x_block_cache";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        if (strcmp(var.value, "enabled") == 0)
+            Settings.CPUBlockCache = TRUE;
+
+    Settings.SA1SyncCycles = 0;
+    var.key="snes9x_sa1_sync";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        if (strcmp(var.value, "instruction") != 0)
+            Settings.SA1SyncCycles = atoi(var.value);
+
+    Settings.SkipIdleLoops = 0;
+    var.key="snes9x_skip_idle_loops";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+    {
+        if (strcmp(var.value, "listed") == 0)
+            Settings.SkipIdleLoops = 1;
+        else if (strcmp(var.value, "enabled") == 0)
+            Settings.SkipIdleLoops = 2;
+    }
+
+    Settings.RunAheadFrames = 0;
+    var.key="snes9x_run_ahead";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        if (strcmp(var.value, "disabled") != 0)
+            Settings.RunAheadFrames = atoi(var.value);
+
+    S9xSetInputLatchCallback(NULL);
+    var.key="snes9x_late_input";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+        if (strcmp(var.value, "enabled") == 0)
+            S9xSetInputLatchCallback(latch_input);
+
+#ifdef S9X_THREADED_RENDER
+    var.key="snes9x_render_thread";
+    var.value=NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && strcmp(var.value, "enabled") == 0)
+        S9xRenderThreadStart();
+    else
+        S9xRenderThreadStop();
+#endif
+
     randomize_memory = false;
     var.key = "snes9x_randomize_memory";
     var.value = NULL;
@@ -756,7 +808,7 @@ void S9xSyncSpeed() {
         return;
     }
 
-    static std::vector<int16_t> audio_buffer;
+    static S9X_TLS std::vector<int16_t> audio_buffer;
 
     size_t avail = S9xGetSampleCount();
 
@@ -851,7 +903,7 @@ void retro_reset()
     S9xSoftReset();
 }
 
-static unsigned snes_devices[8];
+static S9X_TLS unsigned snes_devices[8];
 void retro_set_controller_port_device(unsigned port, unsigned device)
 {
     if (port < 8)
@@ -1212,6 +1264,10 @@ bool retro_load_game_special(unsigned game_type, const struct retro_game_info *i
             }
             else if(num_info == 2)
             {
+#ifdef S9X_MULTI_INSTANCE
+                // BIOSROM lives in this instance's own ROM storage, released while a previous game was shared
+                Memory.UnshareROM();
+#endif
                 memcpy(Memory.BIOSROM,(const uint8_t*)romptr[0],info[0].size);
                 rom_loaded = Memory.LoadROMMem((const uint8_t*)romptr[1],info[1].size);
             }
@@ -1513,8 +1569,8 @@ static void map_buttons()
 
 }
 
-static int16_t snes_mouse_state[2][2] = {{0}, {0}};
-static bool snes_superscope_turbo_latch = false;
+static S9X_TLS int16_t snes_mouse_state[2][2] = {{0}, {0}};
+static S9X_TLS bool snes_superscope_turbo_latch = false;
 
 static void input_report_gun_position( unsigned port, int s9xinput )
 {
@@ -1817,9 +1873,16 @@ static void report_buttons()
     }
 }
 
+// called by the core the first time the game latches the controllers in a frame
+static void latch_input()
+{
+    poll_cb();
+    report_buttons();
+}
+
 void retro_run()
 {
-    static uint16 height = PPU.ScreenHeight;
+    static S9X_TLS uint16 height = PPU.ScreenHeight;
     bool updated = false;
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
         update_variables();
@@ -1845,13 +1908,31 @@ void retro_run()
         S9xSetSoundMute(false);
     }
 
-    poll_cb();
-    report_buttons();
-    S9xMainLoop();
+    bool late = S9xLateInputLatch();
+    if (!late)
+    {
+        poll_cb();
+        report_buttons();
+    }
+
+    // with video off the frontend is running hidden frames of its own
+    if (Settings.RunAheadFrames && IPPU.RenderThisFrame)
+        S9xMainLoopRunAhead();
+    else
+        S9xMainLoop();
+
+    // the game never latched the controllers this frame, but the frontend still expects a poll every run
+    // and the crosshairs, mouse and superscope still follow the input
+    if (!S9xInputLatchFired() && late)
+        latch_input();
 }
 
 void retro_deinit()
 {
+#ifdef CPU_PROFILER
+    S9xProfileReport(S9xGetFilename(".prof", LOG_DIR).c_str());
+    S9xProfileReset();
+#endif
     S9xDeinitAPU();
     Memory.Deinit();
     S9xGraphicsDeinit();
@@ -1971,7 +2052,7 @@ bool retro_unserialize(const void* data, size_t size)
 
 bool8 S9xDeinitUpdate(int width, int height)
 {
-    static int burst_phase = 0;
+    static S9X_TLS int burst_phase = 0;
     int overscan_offset = 0;
 
     if (crop_overscan_mode == OVERSCAN_CROP_ON)
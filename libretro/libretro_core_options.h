@@ -203,6 +203,77 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled"
    },
+   {
+      "snes9x_block_cache",
+      "CPU Block Cache",
+      "Runs straight-line code in ROM from predecoded blocks. Emulation is unchanged; uses about 600 KB more memory.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      "snes9x_sa1_sync",
+      "SA-1 Sync Interval",
+      "How often the SA-1 coprocessor catches up with the main CPU. Longer intervals are faster but can break games that poll shared memory with tight timing.",
+      {
+         { "instruction", "Every Instruction" },
+         { "128",         "128 Master Cycles" },
+         { "512",         "512 Master Cycles" },
+         { NULL, NULL},
+      },
+      "instruction"
+   },
+   {
+      "snes9x_skip_idle_loops",
+      "Skip Idle Loops",
+      "Fast-forwards the CPU through loops that wait for V-blank or H-blank without changing anything. Emulation is unchanged; 'Listed Titles' only does it for games known to benefit.",
+      {
+         { "disabled", NULL },
+         { "listed",   "Listed Titles" },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      "snes9x_run_ahead",
+      "Internal Run-Ahead",
+      "Shows frames ahead of the game and rolls back each time, hiding the game's own input lag. Each frame costs one more frame of emulation plus a savestate. Not used while a movie plays.",
+      {
+         { "disabled", NULL },
+         { "1",        "1 Frame" },
+         { "2",        "2 Frames" },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      "snes9x_late_input",
+      "Late Input Latching",
+      "Reads the controllers when the game latches them instead of before each frame, which can save up to a frame of input lag. Movies keep reading them once per frame.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+#ifdef S9X_THREADED_RENDER
+   {
+      "snes9x_render_thread",
+      "Render Thread",
+      "Draws the picture on a second thread while the next lines are emulated. Needs a spare CPU core.",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+#endif
    {
       "snes9x_randomize_memory",
       "Randomize Memory (Unsafe)",
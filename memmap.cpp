@@ -37,6 +37,15 @@
 #include "display.h"
 #include "sha256.h"
 #include "snapshot.h"
+#include "cpuexec.h"
+#ifdef USE_REX
+#include "rex.h"
+#endif
+
+#ifdef S9X_MULTI_INSTANCE
+#include <map>
+#include <mutex>
+#endif
 
 #ifndef SET_UI_COLOR
 #define SET_UI_COLOR(r, g, b) ;
@@ -50,7 +59,16 @@
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 #endif
 
-static bool8	stopMovie = TRUE;
+static S9X_TLS bool8	stopMovie = TRUE;
+
+#ifdef S9X_MULTI_INSTANCE
+extern S9X_TLS uint8	*HDMAMemPointers[8];
+
+// Images of plain cartridges loaded by more than one instance, keyed by SHA-256. Each instance holds a reference
+// while it runs the image, and the last one to let go frees it.
+static std::mutex	SharedROMLock;
+static std::map<std::string, std::weak_ptr<std::vector<uint8_t> > >	SharedROMs;
+#endif
 
 // from NSRT
 static const char	*nintendo_licensees[] =
@@ -930,6 +948,8 @@ bool8 CMemory::Init (void)
 		return (FALSE);
     }
 
+	FillRAMStorage.resize(0x8000);
+	std::fill(FillRAMStorage.begin(), FillRAMStorage.end(), 0);
 	ROMStorage.resize(MAX_ROM_SIZE + 0x200 + 0x8000);
 	std::fill(ROMStorage.begin(), ROMStorage.end(), 0);
 	SRAMStorage.resize(SRAM_SIZE);
@@ -953,27 +973,22 @@ bool8 CMemory::Init (void)
 	memset(IPPU.TileCached[TILE_2BIT_ODD], 0,  MAX_2BIT_TILES);
 	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
 	memset(IPPU.TileCached[TILE_4BIT_ODD], 0,  MAX_4BIT_TILES);
+	S9xResetTileCache();
 
-	// FillRAM uses first 32K of ROM image area, otherwise space just
-	// wasted. Might be read by the SuperFX code.
+	// FillRAM has its own 32K rather than the start of the ROM image area,
+	// so the image can be released while FillRAM stays put.
 
-	FillRAM = &ROMStorage[0];
+	FillRAM = &FillRAMStorage[0];
 
 	// Add 0x8000 to ROM image pointer to stop SuperFX code accessing
 	// unallocated memory (can cause crash on some ports).
 
-	ROM = &ROMStorage[0x8000];
-
-	C4RAM   = ROM + 0x400000 + 8192 * 8; // C4
-	OBC1RAM = ROM + 0x400000; // OBC1
-	BIOSROM = ROM + 0x300000; // BS
-	BSRAM   = ROM + 0x400000; // BS
+	SetROMPointers(&ROMStorage[0x8000]);
 
 	SuperFX.pvRegisters = FillRAM + 0x3000;
 	SuperFX.nRamBanks   = 2; // Most only use 1.  1=64KB=512Mb, 2=128KB=1024Mb
 	SuperFX.pvRam       = SRAM;
 	SuperFX.nRomBanks   = (2 * 1024 * 1024) / (32 * 1024);
-	SuperFX.pvRom       = (uint8 *) ROM;
 
 	PostRomInitFunc = NULL;
 
@@ -983,6 +998,9 @@ bool8 CMemory::Init (void)
 void CMemory::Deinit (void)
 {
 	ROM = NULL;
+#ifdef S9X_MULTI_INSTANCE
+	SharedROM.reset();
+#endif
 
 	for (int t = 0; t < 7; t++)
 	{
@@ -1000,6 +1018,118 @@ void CMemory::Deinit (void)
 	}
 }
 
+void CMemory::SetROMPointers (uint8 *rom)
+{
+	ROM = rom;
+
+	C4RAM   = ROM + 0x400000 + 8192 * 8; // C4
+	OBC1RAM = ROM + 0x400000; // OBC1
+	BIOSROM = ROM + 0x300000; // BS
+	BSRAM   = ROM + 0x400000; // BS
+
+	SuperFX.pvRom = (uint8 *) ROM;
+}
+
+#ifdef S9X_MULTI_INSTANCE
+// moves p from the image at from to the same place in the image at to. p is biased by base, the bus offset of the
+// bytes it is used with, the way Block[].Map and CPU.PCBase are.
+static inline void RebaseROMPointer (uint8 *&p, uint32 base, const uint8 *from, uint8 *to, uint32 size)
+{
+	if (p >= (uint8 *) CMemory::MAP_LAST && p + base >= from && p + base < from + size)
+		p = to + (p - from);
+}
+
+void CMemory::RebaseROM (uint8 *to)
+{
+	for (int c = 0; c < MEMMAP_NUM_BLOCKS; c++)
+	{
+		if (Block[c].IsROM)
+			RebaseROMPointer(Block[c].Map, (c & 0xf) << MEMMAP_SHIFT, ROM, to, CalculatedSize);
+	}
+
+#ifdef USE_REX
+	if (REXNMIBlock)
+		RebaseROMPointer(REXNMIBlock, 0xf000, ROM, to, CalculatedSize);
+#endif
+
+	for (int d = 0; d < 8; d++)
+	{
+		if (HDMAMemPointers[d])
+			RebaseROMPointer(HDMAMemPointers[d], 0, ROM, to, CalculatedSize);
+	}
+
+	if (CPU.PCBase)
+		RebaseROMPointer(CPU.PCBase, Registers.PCw, ROM, to, CalculatedSize);
+
+	S9xResetCPUBlockCache();
+}
+
+// Called once a cartridge is mapped. A cartridge whose image nothing writes to after loading (no coprocessor
+// keeping RAM or scratch space in the ROM area, no BS-X, no multi-cart) runs from one copy shared by every instance
+// that loaded the same image, and this instance's own MAX_ROM_SIZE buffer is released until it is needed again.
+void CMemory::ShareROM (void)
+{
+	if (SharedROM || Multi.cartType || Settings.SuperFX || Settings.SA1 || Settings.C4 || Settings.SDD1 ||
+		Settings.SPC7110 || Settings.OBC1 || Settings.SETA || Settings.BS)
+		return;
+
+	// banks are mapped whole even when the image is smaller, so keep at least one 64K bank
+	size_t	size = 0x8000 + max(CalculatedSize, 0x10000);
+	std::string	key((const char *) ROMSHA256, sizeof(ROMSHA256));
+	std::shared_ptr<std::vector<uint8_t> >	image;
+
+	{
+		std::lock_guard<std::mutex>	lock(SharedROMLock);
+
+		for (auto i = SharedROMs.begin(); i != SharedROMs.end();)
+		{
+			if (i->second.expired())
+				i = SharedROMs.erase(i);
+			else
+				i++;
+		}
+
+		image = SharedROMs[key].lock();
+		if (!image || image->size() != size)
+		{
+			image = std::make_shared<std::vector<uint8_t> >(size);
+			memcpy(&(*image)[0x8000], ROM, CalculatedSize);
+			SharedROMs[key] = image;
+		}
+	}
+
+	RebaseROM(&(*image)[0x8000]);
+	ROM = &(*image)[0x8000];
+	C4RAM = OBC1RAM = BIOSROM = BSRAM = NULL;
+	SuperFX.pvRom = ROM;
+	SharedROM = image;
+
+	std::vector<uint8_t>().swap(ROMStorage);
+}
+
+// Gives this instance its own writable copy of the image again, before the next load or a cheat that patches
+// ROM. Returns TRUE if the image moved.
+bool8 CMemory::UnshareROM (void)
+{
+	if (!SharedROM)
+		return (FALSE);
+
+	ROMStorage.resize(MAX_ROM_SIZE + 0x200 + 0x8000);
+	std::fill(ROMStorage.begin(), ROMStorage.end(), 0);
+	memcpy(&ROMStorage[0x8000], ROM, CalculatedSize);
+
+	RebaseROM(&ROMStorage[0x8000]);
+	SetROMPointers(&ROMStorage[0x8000]);
+	SharedROM.reset();
+
+#ifdef USE_REX
+	rex_set_chip(REX_CHIP_ROM, ROM, CalculatedSize, FALSE);
+#endif
+
+	return (TRUE);
+}
+#endif
+
 // file management and ROM detection
 
 static bool8 allASCII (uint8 *b, int size)
@@ -1306,6 +1436,10 @@ bool8 CMemory::LoadROMMem (const uint8 *source, uint32 sourceSize, const char* o
     if(!source || sourceSize > MAX_ROM_SIZE)
         return FALSE;
 
+#ifdef S9X_MULTI_INSTANCE
+    UnshareROM();
+#endif
+
     if (optional_rom_filename)
         ROMFilename = optional_rom_filename;
     else
@@ -1329,6 +1463,10 @@ bool8 CMemory::LoadROM (const char *filename)
 
     S9xResetSaveTimer(FALSE); // reset oops timer here so that .oops file has rom name of previous rom
 
+#ifdef S9X_MULTI_INSTANCE
+    UnshareROM();
+#endif
+
     int32 totalFileSize;
 
     do
@@ -1554,6 +1692,9 @@ bool8 CMemory::LoadROMInt (int32 ROMfillSize)
 	SNESGameFixes.SRAMInitialValue = 0x60;
 
 	InitROM();
+#ifdef S9X_MULTI_INSTANCE
+	ShareROM();
+#endif
 
 	S9xReset();
 
@@ -1568,6 +1709,9 @@ bool8 CMemory::LoadMultiCartMem (const uint8 *sourceA, uint32 sourceASize,
                                  const uint8 *bios, uint32 biosSize)
 {
     uint32 offset = 0;
+#ifdef S9X_MULTI_INSTANCE
+    UnshareROM();
+#endif
     memset(ROM, 0, MAX_ROM_SIZE);
 	memset(&Multi, 0, sizeof(Multi));
 
@@ -1602,6 +1746,10 @@ bool8 CMemory::LoadMultiCart (const char *cartA, const char *cartB)
 {
     S9xResetSaveTimer(FALSE); // reset oops timer here so that .oops file has rom name of previous rom
 
+#ifdef S9X_MULTI_INSTANCE
+    UnshareROM();
+#endif
+
     memset(ROM, 0, MAX_ROM_SIZE);
 	memset(&Multi, 0, sizeof(Multi));
 
@@ -2499,9 +2647,9 @@ void CMemory::map_lorom (uint32 bank_s, uint32 bank_e, uint32 addr_s, uint32 add
 		{
 			p = (c << 4) | (i >> 12);
 			addr = (c & 0x7f) * 0x8000;
-			Map[p] = ROM + map_mirror(size, addr) - (i & 0x8000);
-			BlockIsROM[p] = TRUE;
-			BlockIsRAM[p] = FALSE;
+			Block[p].Map = ROM + map_mirror(size, addr) - (i & 0x8000);
+			Block[p].IsROM = TRUE;
+			Block[p].IsRAM = FALSE;
 		}
 	}
 }
@@ -2516,9 +2664,9 @@ void CMemory::map_hirom (uint32 bank_s, uint32 bank_e, uint32 addr_s, uint32 add
 		{
 			p = (c << 4) | (i >> 12);
 			addr = c << 16;
-			Map[p] = ROM + map_mirror(size, addr);
-			BlockIsROM[p] = TRUE;
-			BlockIsRAM[p] = FALSE;
+			Block[p].Map = ROM + map_mirror(size, addr);
+			Block[p].IsROM = TRUE;
+			Block[p].IsRAM = FALSE;
 		}
 	}
 }
@@ -2533,9 +2681,9 @@ void CMemory::map_lorom_offset (uint32 bank_s, uint32 bank_e, uint32 addr_s, uin
 		{
 			p = (c << 4) | (i >> 12);
 			addr = ((c - bank_s) & 0x7f) * 0x8000;
-			Map[p] = ROM + offset + map_mirror(size, addr) - (i & 0x8000);
-			BlockIsROM[p] = TRUE;
-			BlockIsRAM[p] = FALSE;
+			Block[p].Map = ROM + offset + map_mirror(size, addr) - (i & 0x8000);
+			Block[p].IsROM = TRUE;
+			Block[p].IsRAM = FALSE;
 		}
 	}
 }
@@ -2550,9 +2698,9 @@ void CMemory::map_hirom_offset (uint32 bank_s, uint32 bank_e, uint32 addr_s, uin
 		{
 			p = (c << 4) | (i >> 12);
 			addr = (c - bank_s) << 16;
-			Map[p] = ROM + offset + map_mirror(size, addr);
-			BlockIsROM[p] = TRUE;
-			BlockIsRAM[p] = FALSE;
+			Block[p].Map = ROM + offset + map_mirror(size, addr);
+			Block[p].IsROM = TRUE;
+			Block[p].IsRAM = FALSE;
 		}
 	}
 }
@@ -2566,9 +2714,9 @@ void CMemory::map_space (uint32 bank_s, uint32 bank_e, uint32 addr_s, uint32 add
 		for (i = addr_s; i <= addr_e; i += 0x1000)
 		{
 			p = (c << 4) | (i >> 12);
-			Map[p] = data;
-			BlockIsROM[p] = FALSE;
-			BlockIsRAM[p] = TRUE;
+			Block[p].Map = data;
+			Block[p].IsROM = FALSE;
+			Block[p].IsRAM = TRUE;
 		}
 	}
 }
@@ -2586,9 +2734,9 @@ void CMemory::map_index (uint32 bank_s, uint32 bank_e, uint32 addr_s, uint32 add
 		for (i = addr_s; i <= addr_e; i += 0x1000)
 		{
 			p = (c << 4) | (i >> 12);
-			Map[p] = (uint8 *) (pint) index;
-			BlockIsROM[p] = isROM;
-			BlockIsRAM[p] = isRAM;
+			Block[p].Map = (uint8 *) (pint) index;
+			Block[p].IsROM = isROM;
+			Block[p].IsRAM = isRAM;
 		}
 	}
 }
@@ -2602,8 +2750,62 @@ void CMemory::map_System (void)
 	map_space(0x80, 0xbf, 0x0000, 0x1fff, RAM);
 	map_index(0x80, 0xbf, 0x2000, 0x3fff, MAP_PPU, MAP_TYPE_I_O);
 	map_index(0x80, 0xbf, 0x4000, 0x5fff, MAP_CPU, MAP_TYPE_I_O);
+
+#ifdef USE_REX
+	map_REX();
+#endif
+}
+
+#ifdef USE_REX
+void CMemory::map_REX (void)
+{
+	// $2000-$2FFF also holds the FX Pak buffer at $2C00-$2DFF; the rest of the block still goes to the PPU
+	map_index(0x00, 0x3f, 0x2000, 0x2fff, MAP_REX_2C00, MAP_TYPE_I_O);
+	map_index(0x80, 0xbf, 0x2000, 0x2fff, MAP_REX_2C00, MAP_TYPE_I_O);
+}
+
+// The FX Pak NMI hook: while armed, the block holding the native NMI vector in bank $00 is swapped for
+// MAP_REX_NMI so the next vector fetch reads $2C00 and hands the block back. Nothing else pays for the hook,
+// and the routine at $2C00 can finish with JMP ($FFEA) to reach the game's own handler.
+bool8 CMemory::ArmREXNMIHook (void)
+{
+	if (REXNMIBlock && Block[0x00f].Map == (uint8 *) MAP_REX_NMI)
+		return (TRUE);
+
+	// only plain memory can be borrowed; a mapper may also have replaced the block since the last arm
+	REXNMIBlock = NULL;
+	if (Block[0x00f].Map < (uint8 *) MAP_LAST)
+		return (FALSE);
+
+	REXNMIBlock = Block[0x00f].Map;
+	Block[0x00f].Map = (uint8 *) MAP_REX_NMI;
+
+	return (TRUE);
 }
 
+void CMemory::DisarmREXNMIHook (void)
+{
+	if (!REXNMIBlock)
+		return;
+
+	if (Block[0x00f].Map == (uint8 *) MAP_REX_NMI)
+		Block[0x00f].Map = REXNMIBlock;
+	REXNMIBlock = NULL;
+}
+
+// Copies a 65816 routine to $2C00 and arms the hook. As on the FX Pak it is re-armed at every VBlank until
+// the routine clears $2C00 itself.
+bool8 CMemory::InjectREXNMIHook (const uint8 *code, uint32 size)
+{
+	if (!code || size == 0 || size > sizeof(REX_2C00))
+		return (FALSE);
+
+	memcpy(REX_2C00, code, size);
+
+	return (ArmREXNMIHook());
+}
+#endif
+
 void CMemory::map_WRAM (void)
 {
 	// will overwrite others
@@ -2701,24 +2903,57 @@ void CMemory::map_SetaDSP (void)
 
 void CMemory::map_WriteProtectROM (void)
 {
-	memmove((void *) WriteMap, (void *) Map, sizeof(Map));
+	for (int c = 0; c < 0x1000; c++)
+	{
+		if (Block[c].IsROM)
+			Block[c].WriteMap = (uint8 *) MAP_NONE;
+		else
+			Block[c].WriteMap = Block[c].Map;
+	}
+}
+
+// Access speeds only depend on the address and the clock settings, so they are refilled when the overclock
+// settings change rather than on every remap. Banks $80-$FF follow MEMSEL through CPU.FastROMSpeed and
+// $x4000-$x4FFF in the system banks mixes 12 and 6 cycle registers, see SMemBlock::Speed.
+void CMemory::UpdateBlockSpeeds (void)
+{
+	int32	key = ONE_CYCLE | (SLOW_ONE_CYCLE << 8) | (TWO_CYCLES << 16);
+
+	if (key == BlockSpeedKey)
+		return;
 
 	for (int c = 0; c < 0x1000; c++)
 	{
-		if (BlockIsROM[c])
-			WriteMap[c] = (uint8 *) MAP_NONE;
+		uint32	address = c << MEMMAP_SHIFT;
+
+		if ((address & 0x40f000) == 0x4000)
+			Block[c].Speed = 0;
+		else
+		if ((address & 0x800000) && (address & 0x408000))
+			Block[c].Speed = -1;
+		else
+			Block[c].Speed = memory_speed(address);
 	}
+
+	BlockSpeedKey = key;
 }
 
 void CMemory::Map_Initialize (void)
 {
 	for (int c = 0; c < 0x1000; c++)
 	{
-		Map[c]      = (uint8 *) MAP_NONE;
-		WriteMap[c] = (uint8 *) MAP_NONE;
-		BlockIsROM[c] = FALSE;
-		BlockIsRAM[c] = FALSE;
+		Block[c].Map      = (uint8 *) MAP_NONE;
+		Block[c].WriteMap = (uint8 *) MAP_NONE;
+		Block[c].Speed    = 0;
+		Block[c].IsROM    = FALSE;
+		Block[c].IsRAM    = FALSE;
 	}
+
+	BlockSpeedKey = -1;
+
+#ifdef USE_REX
+	REXNMIBlock = NULL;
+#endif
 }
 
 void CMemory::Map_LoROMMap (void)
@@ -2997,29 +3232,28 @@ void CMemory::Map_SA1LoROMMap (void)
 	map_WriteProtectROM();
 
 	// Now copy the map and correct it for the SA1 CPU.
-	memmove((void *) SA1.Map, (void *) Map, sizeof(Map));
-	memmove((void *) SA1.WriteMap, (void *) WriteMap, sizeof(WriteMap));
+	memmove((void *) SA1.Block, (void *) Block, sizeof(Block));
 
 	// SA-1 Banks 00->3f and 80->bf
 	for (int c = 0x000; c < 0x400; c += 0x10)
 	{
-		SA1.Map[c + 0] = SA1.Map[c + 0x800] = FillRAM + 0x3000;
-		SA1.Map[c + 1] = SA1.Map[c + 0x801] = (uint8 *) MAP_NONE;
-		SA1.WriteMap[c + 0] = SA1.WriteMap[c + 0x800] = FillRAM + 0x3000;
-		SA1.WriteMap[c + 1] = SA1.WriteMap[c + 0x801] = (uint8 *) MAP_NONE;
+		SA1.Block[c + 0].Map = SA1.Block[c + 0x800].Map = FillRAM + 0x3000;
+		SA1.Block[c + 1].Map = SA1.Block[c + 0x801].Map = (uint8 *) MAP_NONE;
+		SA1.Block[c + 0].WriteMap = SA1.Block[c + 0x800].WriteMap = FillRAM + 0x3000;
+		SA1.Block[c + 1].WriteMap = SA1.Block[c + 0x801].WriteMap = (uint8 *) MAP_NONE;
 	}
 
 	// SA-1 Banks 40->4f
 	for (int c = 0x400; c < 0x500; c++)
-		SA1.Map[c] = SA1.WriteMap[c] = (uint8*) MAP_SA1RAM;
+		SA1.Block[c].Map = SA1.Block[c].WriteMap = (uint8*) MAP_SA1RAM;
 
 	// SA-1 Banks 60->6f
 	for (int c = 0x600; c < 0x700; c++)
-		SA1.Map[c] = SA1.WriteMap[c] = (uint8 *) MAP_BWRAM_BITMAP;
+		SA1.Block[c].Map = SA1.Block[c].WriteMap = (uint8 *) MAP_BWRAM_BITMAP;
 
 	// WRAM is inaccessable
 	for (int c = 0x7e0; c < 0x800; c++)
-		SA1.Map[c] = SA1.WriteMap[c] = (uint8 *) MAP_NONE;
+		SA1.Block[c].Map = SA1.Block[c].WriteMap = (uint8 *) MAP_NONE;
 
 	BWRAM = SRAM;
 }
@@ -3047,25 +3281,24 @@ void CMemory::Map_BSSA1LoROMMap(void)
 	map_WriteProtectROM();
 
 	// Now copy the map and correct it for the SA1 CPU.
-	memmove((void *) SA1.Map, (void *) Map, sizeof(Map));
-	memmove((void *) SA1.WriteMap, (void *) WriteMap, sizeof(WriteMap));
+	memmove((void *) SA1.Block, (void *) Block, sizeof(Block));
 
 	// SA-1 Banks 00->3f and 80->bf
 	for (int c = 0x000; c < 0x400; c += 0x10)
 	{
-		SA1.Map[c + 0] = SA1.Map[c + 0x800] = FillRAM + 0x3000;
-		SA1.Map[c + 1] = SA1.Map[c + 0x801] = (uint8 *) MAP_NONE;
-		SA1.WriteMap[c + 0] = SA1.WriteMap[c + 0x800] = FillRAM + 0x3000;
-		SA1.WriteMap[c + 1] = SA1.WriteMap[c + 0x801] = (uint8 *) MAP_NONE;
+		SA1.Block[c + 0].Map = SA1.Block[c + 0x800].Map = FillRAM + 0x3000;
+		SA1.Block[c + 1].Map = SA1.Block[c + 0x801].Map = (uint8 *) MAP_NONE;
+		SA1.Block[c + 0].WriteMap = SA1.Block[c + 0x800].WriteMap = FillRAM + 0x3000;
+		SA1.Block[c + 1].WriteMap = SA1.Block[c + 0x801].WriteMap = (uint8 *) MAP_NONE;
 	}
 
 	// SA-1 Banks 60->6f
 	for (int c = 0x600; c < 0x700; c++)
-		SA1.Map[c] = SA1.WriteMap[c] = (uint8 *) MAP_BWRAM_BITMAP;
+		SA1.Block[c].Map = SA1.Block[c].WriteMap = (uint8 *) MAP_BWRAM_BITMAP;
 
 	// WRAM is inaccessable
 	for (int c = 0x7e0; c < 0x800; c++)
-		SA1.Map[c] = SA1.WriteMap[c] = (uint8 *) MAP_NONE;
+		SA1.Block[c].Map = SA1.Block[c].WriteMap = (uint8 *) MAP_NONE;
 
 	BWRAM = SRAM;
 }
@@ -3264,7 +3497,7 @@ const char * CMemory::MapType (void)
 
 const char * CMemory::StaticRAMSize (void)
 {
-	static char	str[20];
+	static S9X_TLS char	str[20];
 
 	if (SRAMSize > 16)
 		strcpy(str, "Corrupt");
@@ -3276,7 +3509,7 @@ const char * CMemory::StaticRAMSize (void)
 
 const char * CMemory::Size (void)
 {
-	static char	str[20];
+	static S9X_TLS char	str[20];
 
 	if (Multi.cartType == 4)
 		strcpy(str, "N/A");
@@ -3290,7 +3523,7 @@ const char * CMemory::Size (void)
 
 const char * CMemory::Revision (void)
 {
-	static char	str[20];
+	static S9X_TLS char	str[20];
 
 	sprintf(str, "1.%d", HiROM ? ((ExtendedFormat != NOPE) ? ROM[0x40ffdb] : ROM[0xffdb]) : ROM[0x7fdb]);
 
@@ -3299,7 +3532,7 @@ const char * CMemory::Revision (void)
 
 const char * CMemory::KartContents (void)
 {
-	static char			str[64];
+	static S9X_TLS char			str[64];
 	static const char	*contents[3] = { "ROM", "ROM+RAM", "ROM+RAM+BAT" };
 
 	char	chip[20];
@@ -3522,6 +3755,13 @@ void CMemory::ApplyROMFixes (void)
 		printf("Applied Uniracers hack.\n");
 	}
 
+	// Idle loop skipping
+	// Allowed titles wait for NMI in a loop the detector recognizes; denied ones race the NMI flag, see above.
+	if (match_na("SUPER MARIOWORLD")) // Super Mario World
+		SNESGameFixes.IdleLoops = 1;
+	else if (match_na("KORYU NO MIMI ENG"))
+		SNESGameFixes.IdleLoops = -1;
+
 	// Render Position
 	if (match_na("Sugoro Quest++"))
 		Timings.RenderPos = 128;
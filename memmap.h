@@ -14,8 +14,22 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <cstdint>
 
+// Everything a bus access needs to know about one 4 KB block, kept together so an access touches one entry.
+// Map and WriteMap are either host pointers biased by the block's bank address, or one of the CMemory::MAP_*
+// handler IDs below MAP_LAST. Speed is the CPU access time in master cycles, -1 where it follows MEMSEL, or 0
+// where it varies inside the block and memory_speed() works it out per address.
+struct SMemBlock
+{
+	uint8	*Map;
+	uint8	*WriteMap;
+	int32	Speed;
+	bool8	IsRAM;
+	bool8	IsROM;
+};
+
 struct CMemory
 {
 	enum
@@ -50,6 +64,10 @@ struct CMemory
 		MAP_SETA_DSP,
 		MAP_SETA_RISC,
 		MAP_BSX,
+#ifdef USE_REX
+		MAP_REX_2C00,
+		MAP_REX_NMI,
+#endif
 		MAP_NONE,
 		MAP_LAST
 	};
@@ -60,13 +78,18 @@ struct CMemory
 	uint8	RAM[0x20000];
 	std::vector<uint8_t> ROMStorage;
 	uint8   *ROM;
+#ifdef S9X_MULTI_INSTANCE
+	std::shared_ptr<std::vector<uint8_t> > SharedROM;	// the image ROM points into while ROMStorage is released
+#endif
 	std::vector<uint8_t> SRAMStorage;
 	uint8	*SRAM;
 	const size_t SRAM_SIZE = 0x80000;
 	uint8	VRAM[0x10000];
 #ifdef USE_REX
 	uint8	REX_2C00[0x200];
+	uint8	*REXNMIBlock;
 #endif
+	std::vector<uint8_t> FillRAMStorage;
 	uint8	*FillRAM;
 	uint8	*BWRAM;
 	uint8	*C4RAM;
@@ -74,10 +97,8 @@ struct CMemory
 	uint8	*BSRAM;
 	uint8	*BIOSROM;
 
-	uint8	*Map[MEMMAP_NUM_BLOCKS];
-	uint8	*WriteMap[MEMMAP_NUM_BLOCKS];
-	uint8	BlockIsRAM[MEMMAP_NUM_BLOCKS];
-	uint8	BlockIsROM[MEMMAP_NUM_BLOCKS];
+	struct SMemBlock	Block[MEMMAP_NUM_BLOCKS];
+	int32	BlockSpeedKey;
 	uint8	ExtendedFormat;
 
 	std::string ROMFilename;
@@ -106,6 +127,12 @@ struct CMemory
 
 	bool8	Init (void);
 	void	Deinit (void);
+	void	SetROMPointers (uint8 *);
+#ifdef S9X_MULTI_INSTANCE
+	void	RebaseROM (uint8 *);
+	void	ShareROM (void);
+	bool8	UnshareROM (void);
+#endif
 
 	int		ScoreHiROM (bool8, int32 romoff = 0);
 	int		ScoreLoROM (bool8, int32 romoff = 0);
@@ -148,6 +175,13 @@ struct CMemory
 	void	map_SetaRISC (void);
 	void	map_SetaDSP (void);
 	void	map_WriteProtectROM (void);
+	void	UpdateBlockSpeeds (void);
+#ifdef USE_REX
+	void	map_REX (void);
+	bool8	ArmREXNMIHook (void);
+	void	DisarmREXNMIHook (void);
+	bool8	InjectREXNMIHook (const uint8 *, uint32);
+#endif
 	void	Map_Initialize (void);
 	void	Map_LoROMMap (void);
 	void	Map_NoMAD1LoROMMap (void);
@@ -202,8 +236,8 @@ struct SMulti
 	char	fileNameA[PATH_MAX + 1], fileNameB[PATH_MAX + 1];
 };
 
-extern CMemory	Memory;
-extern SMulti	Multi;
+extern S9X_TLS CMemory	Memory;
+extern S9X_TLS SMulti	Multi;
 
 inline bool S9xInterlaceField()
 {
@@ -13,13 +13,13 @@
 #include <fstream>
 #include <sys/stat.h>
 
-STREAM dataStream = NULL;
-STREAM audioStream = NULL;
-uint32 audioLoopPos;
-size_t partial_frames;
+S9X_TLS STREAM dataStream = NULL;
+S9X_TLS STREAM audioStream = NULL;
+S9X_TLS uint32 audioLoopPos;
+S9X_TLS size_t partial_frames;
 
 // Sample buffer
-static Resampler *msu_resampler = NULL;
+static S9X_TLS Resampler *msu_resampler = NULL;
 
 #ifdef UNZIP_SUPPORT
 static int unzFindExtension(unzFile &file, const char *ext, bool restart = TRUE, bool print = TRUE, bool allowExact = FALSE)
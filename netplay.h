@@ -147,7 +147,7 @@ struct SNetPlay
     char   WarningMsg [NP_MAX_ACTION_LEN];
 };
 
-extern "C" struct SNetPlay NetPlay;
+extern "C" S9X_TLS struct SNetPlay NetPlay;
 
 //
 // NETPLAY_CLIENT_HELLO message format:
@@ -52,6 +52,26 @@
 #define alwaysinline  inline
 #endif
 
+// With S9X_MULTI_INSTANCE all emulation state is per thread, so every thread that initialises the core runs its own SNES
+#ifdef S9X_MULTI_INSTANCE
+#define S9X_TLS       thread_local
+#else
+#define S9X_TLS
+#endif
+
+// vector code paths where the target has SSE2 or NEON; S9X_NO_SIMD keeps everything scalar
+#ifndef S9X_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define S9X_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define S9X_SIMD_NEON
+#endif
+#endif
+
+#if defined(S9X_SIMD_SSE2) || defined(S9X_SIMD_NEON)
+#define S9X_SIMD
+#endif
+
 #ifndef snes9x_types_defined
 #define snes9x_types_defined
 typedef unsigned char		bool8;
@@ -22,7 +22,7 @@
 #include "missing.h"
 #endif
 
-extern uint8	*HDMAMemPointers[8];
+extern S9X_TLS uint8	*HDMAMemPointers[8];
 
 
 static inline void S9xLatchCounters (bool force)
@@ -209,12 +209,6 @@ void S9xFixColourBrightness (void)
 void S9xSetPPU (uint8 Byte, uint16 Address)
 {
 	// MAP_PPU: $2000-$3FFF
-#ifdef USE_REX
-	if (Address >= 0x2C00 && Address < 0x2E00)
-	{
-		Memory.REX_2C00[Address - 0x2C00] = Byte;
-	}
-#endif
 
 	if (CPU.InDMAorHDMA)
 	{
@@ -884,6 +878,10 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 							IPPU.RenderedScreenHeight = PPU.ScreenHeight;
 					}
 
+					// overscan can give this line the render and HDMA it did not have
+					S9xWakeHEvent(HC_RENDER_EVENT);
+					S9xWakeHEvent(HC_HDMA_START_EVENT);
+
 					if ((Memory.FillRAM[0x2133] ^ Byte) & 3)
 					{
 						FLUSH_REDRAW();
@@ -965,6 +963,10 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 		else
 		if (Settings.SA1     && Address >= 0x2200)
 		{
+			// a sliced SA-1 is caught up before the CPU talks to it
+			if (Settings.SA1SyncCycles > 0)
+				S9xSA1MainLoop();
+
 			if (Address <= 0x23ff)
 				S9xSetSA1(Byte, Address);
 			else
@@ -996,12 +998,6 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 uint8 S9xGetPPU (uint16 Address)
 {
 	// MAP_PPU: $2000-$3FFF
-#ifdef USE_REX
-	if (Address >= 0x2C00 && Address < 0x2E00)
-	{
-		return Memory.REX_2C00[Address - 0x2C00];
-	}
-#endif
 	if (Settings.MSU1 && (Address & 0xfff8) == 0x2000)
 		return (S9xMSU1ReadPort(Address & 7));
 	else
@@ -1222,7 +1218,12 @@ uint8 S9xGetPPU (uint16 Address)
 			return (S9xGetSuperFX(Address));
 		else
 		if (Settings.SA1     && Address >= 0x2200)
+		{
+			if (Settings.SA1SyncCycles > 0)
+				S9xSA1MainLoop();
+
 			return (S9xGetSA1(Address));
+		}
 		else
 		if (Settings.BS      && Address >= 0x2188 && Address <= 0x219f)
 			return (S9xGetBSXPPU(Address));
@@ -1542,6 +1543,7 @@ void S9xSetCPU (uint8 Byte, uint16 Address)
 				Memory.FillRAM[0x420c] = Byte;
 				// Yoshi's Island, Genjyu Ryodan, Mortal Kombat, Tales of Phantasia
 				PPU.HDMA = Byte & ~PPU.HDMAEnded;
+				S9xWakeHEvent(HC_HDMA_START_EVENT);
 			#ifdef DEBUGGER
 				missing.hdma_this_frame |= Byte;
 				missing.hdma_channels |= Byte;
@@ -1602,7 +1604,7 @@ uint8 S9xGetCPU (uint16 Address)
 	if (Address < 0x4200)
 	{
 	#ifdef SNES_JOY_READ_CALLBACKS
-		extern bool8 pad_read;
+		extern S9X_TLS bool8 pad_read;
 		if (Address == 0x4016 || Address == 0x4017)
 		{
 			S9xOnSNESPadRead();
@@ -1719,7 +1721,7 @@ uint8 S9xGetCPU (uint16 Address)
 			case 0x421e: // JOY4L
 			case 0x421f: // JOY4H
 			#ifdef SNES_JOY_READ_CALLBACKS
-				extern bool8 pad_read;
+				extern S9X_TLS bool8 pad_read;
 				if (Memory.FillRAM[0x4200] & 1)
 				{
 					S9xOnSNESPadRead();
@@ -1752,13 +1754,9 @@ void S9xResetPPUFast (void)
 	PPU.RecomputeClipWindows = TRUE;
 	IPPU.ColorsChanged = TRUE;
 	IPPU.OBJChanged = TRUE;
-	memset(IPPU.TileCached[TILE_2BIT], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_8BIT], 0, MAX_8BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_EVEN], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_ODD], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_ODD], 0, MAX_4BIT_TILES);
+	IPPU.OBJDirty[0] = IPPU.OBJDirty[1] = ~(uint64) 0;
+	S9xResetTileCache();
+	RENDER_THREAD_VRAM_RESET();
 }
 
 void S9xSoftResetPPU (void)
@@ -1898,13 +1896,9 @@ void S9xSoftResetPPU (void)
 		memset(&IPPU.Clip[c], 0, sizeof(struct ClipData));
 	IPPU.ColorsChanged = TRUE;
 	IPPU.OBJChanged = TRUE;
-	memset(IPPU.TileCached[TILE_2BIT], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_8BIT], 0, MAX_8BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_EVEN], 0, MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_2BIT_ODD], 0,  MAX_2BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_EVEN], 0, MAX_4BIT_TILES);
-	memset(IPPU.TileCached[TILE_4BIT_ODD], 0,  MAX_4BIT_TILES);
+	IPPU.OBJDirty[0] = IPPU.OBJDirty[1] = ~(uint64) 0;
+	S9xResetTileCache();
+	RENDER_THREAD_VRAM_RESET();
 	PPU.VRAMReadBuffer = 0; // XXX: FIXME: anything better?
 	GFX.DoInterlace = 0;
 	IPPU.Interlace = FALSE;
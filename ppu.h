@@ -7,6 +7,8 @@
 #ifndef _PPU_H_
 #define _PPU_H_
 
+#include "renderthread.h"
+
 #define FIRST_VISIBLE_LINE	1
 
 #define TILE_2BIT			0
@@ -39,8 +41,14 @@ struct InternalPPU
 	struct ClipData Clip[2][6];
 	bool8	ColorsChanged;
 	bool8	OBJChanged;
+	uint64	OBJDirty[2];						// sprites OAM writes have resized, moved or flipped vertically since SetupOBJ
 	uint8	*TileCache[7];
 	uint8	*TileCached[7];
+	uint64	VRAMDirty[MAX_2BIT_TILES / 64];		// 16-byte units written since the caches last caught up, a word per 1K
+	uint64	VRAMDirtyWords;						// which words of VRAMDirty have bits set
+	uint64	TileDirty[7][MAX_2BIT_TILES / 64];	// tiles each cache has to convert before it is drawn from
+	uint64	TileDirtyWords[7];
+	uint32	TileWrapBase[7];					// the character base the hires caches' tile 0x3ff was converted against
 	bool8	Interlace;
 	bool8	InterlaceOBJ;
 	bool8	PseudoHires;
@@ -196,11 +204,12 @@ struct SPPU
 };
 
 extern uint16				SignExtend[2];
-extern struct SPPU			PPU;
-extern struct InternalPPU	IPPU;
+extern S9X_TLS struct SPPU			PPU;
+extern S9X_TLS struct InternalPPU	IPPU;
 
 void S9xResetPPU (void);
 void S9xResetPPUFast (void);
+void S9xResetTileCache (void);
 void S9xSoftResetPPU (void);
 void S9xSetPPU (uint8, uint16);
 uint8 S9xGetPPU (uint16);
@@ -220,7 +229,7 @@ typedef struct
 	uint8	_5A22;
 }	SnesModel;
 
-extern SnesModel	*Model;
+extern S9X_TLS SnesModel	*Model;
 extern SnesModel	M1SNES;
 extern SnesModel	M2SNES;
 
@@ -261,12 +270,16 @@ static inline void REGISTER_2104 (uint8 Byte)
 		int addr = ((PPU.OAMAddr & 0x10f) << 1) + (PPU.OAMFlip & 1);
 		if (Byte != PPU.OAMData[addr])
 		{
+			uint8	changed = Byte ^ PPU.OAMData[addr];
+			uint32	s = (addr & 0x1f) * 4;
+
 			FLUSH_REDRAW();
 			PPU.OAMData[addr] = Byte;
+			IPPU.OBJDirty[s >> 6] |= (uint64) (((changed & 0x03) ? 1 : 0) | ((changed & 0x0c) ? 2 : 0) | ((changed & 0x30) ? 4 : 0) | ((changed & 0xc0) ? 8 : 0)) << (s & 63);
 			IPPU.OBJChanged = TRUE;
 
 			// X position high bit, and sprite size (x4)
-			struct SOBJ *pObj = &PPU.OBJ[(addr & 0x1f) * 4];
+			struct SOBJ *pObj = &PPU.OBJ[s];
 			pObj->HPos = (pObj->HPos & 0xFF) | SignExtend[(Byte >> 0) & 1];
 			pObj++->Size = Byte & 2;
 			pObj->HPos = (pObj->HPos & 0xFF) | SignExtend[(Byte >> 2) & 1];
@@ -288,10 +301,17 @@ static inline void REGISTER_2104 (uint8 Byte)
 		int addr = (PPU.OAMAddr << 1);
 		if (lowbyte != PPU.OAMData[addr] || highbyte != PPU.OAMData[addr + 1])
 		{
+			// the name, palette, priority and horizontal flip don't change which lines the sprite is on
+			bool8	moved = !(addr & 2) || ((highbyte ^ PPU.OAMData[addr + 1]) & 0x80);
+
 			FLUSH_REDRAW();
 			PPU.OAMData[addr] = lowbyte;
 			PPU.OAMData[addr + 1] = highbyte;
-			IPPU.OBJChanged = TRUE;
+			if (moved)
+			{
+				IPPU.OBJDirty[PPU.OAMAddr >> 7] |= (uint64) 1 << ((PPU.OAMAddr >> 1) & 63);
+				IPPU.OBJChanged = TRUE;
+			}
 			if (addr & 2)
 			{
 				// Tile
@@ -331,6 +351,13 @@ static inline void REGISTER_2104 (uint8 Byte)
 	}
 }
 
+// Only the 16 bytes written to are marked here; the tiles of every depth that use them are worked out when the caches catch up.
+#define TILE_CACHE_VRAM_WRITE(address) \
+	{ \
+		IPPU.VRAMDirty[(address) >> 10] |= (uint64) 1 << (((address) >> 4) & 63); \
+		IPPU.VRAMDirtyWords |= (uint64) 1 << ((address) >> 10); \
+	}
+
 // This code is correct, however due to Snes9x's inaccurate timings, some games might be broken by this chage. :(
 #ifdef DEBUGGER
 #define CHECK_INBLANK() \
@@ -367,17 +394,8 @@ static inline void REGISTER_2118 (uint8 Byte)
 	else
 		Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (!PPU.VMA.High)
 	{
@@ -398,17 +416,8 @@ static inline void REGISTER_2118_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -422,17 +431,8 @@ static inline void REGISTER_2118_linear (uint8 Byte)
 
 	Memory.VRAM[address = (PPU.VMA.Address << 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (!PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -474,17 +474,8 @@ static inline void REGISTER_2119 (uint8 Byte)
 	else
 		Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (PPU.VMA.High)
 	{
@@ -505,17 +496,8 @@ static inline void REGISTER_2119_tile (uint8 Byte)
 
 	Memory.VRAM[address] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -529,17 +511,8 @@ static inline void REGISTER_2119_linear (uint8 Byte)
 
 	Memory.VRAM[address = ((PPU.VMA.Address << 1) + 1) & 0xffff] = Byte;
 
-	IPPU.TileCached[TILE_2BIT][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_4BIT][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_8BIT][address >> 6] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_EVEN][((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [address >> 4] = FALSE;
-	IPPU.TileCached[TILE_2BIT_ODD] [((address >> 4) - 1) & (MAX_2BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_EVEN][((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [address >> 5] = FALSE;
-	IPPU.TileCached[TILE_4BIT_ODD] [((address >> 5) - 1) & (MAX_4BIT_TILES - 1)] = FALSE;
+	TILE_CACHE_VRAM_WRITE(address);
+	RENDER_THREAD_VRAM_WRITE(address);
 
 	if (PPU.VMA.High)
 		PPU.VMA.Address += PPU.VMA.Increment;
@@ -0,0 +1,193 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifdef CPU_PROFILER
+
+#include <vector>
+#include <algorithm>
+#include "snes9x.h"
+#include "profiler.h"
+
+#define PROFILE_TOP_PCS	200
+
+S9X_TLS struct SProfiler	CPUProfile;
+S9X_TLS struct SProfiler	SA1Profile;
+
+static const char	*ProfileMnemonics[256] =
+{
+	"BRK", "ORA", "COP", "ORA", "TSB", "ORA", "ASL", "ORA",
+	"PHP", "ORA", "ASL", "PHD", "TSB", "ORA", "ASL", "ORA",
+	"BPL", "ORA", "ORA", "ORA", "TRB", "ORA", "ASL", "ORA",
+	"CLC", "ORA", "INC", "TCS", "TRB", "ORA", "ASL", "ORA",
+	"JSR", "AND", "JSL", "AND", "BIT", "AND", "ROL", "AND",
+	"PLP", "AND", "ROL", "PLD", "BIT", "AND", "ROL", "AND",
+	"BMI", "AND", "AND", "AND", "BIT", "AND", "ROL", "AND",
+	"SEC", "AND", "DEC", "TSC", "BIT", "AND", "ROL", "AND",
+	"RTI", "EOR", "WDM", "EOR", "MVP", "EOR", "LSR", "EOR",
+	"PHA", "EOR", "LSR", "PHK", "JMP", "EOR", "LSR", "EOR",
+	"BVC", "EOR", "EOR", "EOR", "MVN", "EOR", "LSR", "EOR",
+	"CLI", "EOR", "PHY", "TCD", "JMP", "EOR", "LSR", "EOR",
+	"RTS", "ADC", "PER", "ADC", "STZ", "ADC", "ROR", "ADC",
+	"PLA", "ADC", "ROR", "RTL", "JMP", "ADC", "ROR", "ADC",
+	"BVS", "ADC", "ADC", "ADC", "STZ", "ADC", "ROR", "ADC",
+	"SEI", "ADC", "PLY", "TDC", "JMP", "ADC", "ROR", "ADC",
+	"BRA", "STA", "BRL", "STA", "STY", "STA", "STX", "STA",
+	"DEY", "BIT", "TXA", "PHB", "STY", "STA", "STX", "STA",
+	"BCC", "STA", "STA", "STA", "STY", "STA", "STX", "STA",
+	"TYA", "STA", "TXS", "TXY", "STZ", "STA", "STZ", "STA",
+	"LDY", "LDA", "LDX", "LDA", "LDY", "LDA", "LDX", "LDA",
+	"TAY", "LDA", "TAX", "PLB", "LDY", "LDA", "LDX", "LDA",
+	"BCS", "LDA", "LDA", "LDA", "LDY", "LDA", "LDX", "LDA",
+	"CLV", "LDA", "TSX", "TYX", "LDY", "LDA", "LDX", "LDA",
+	"CPY", "CMP", "REP", "CMP", "CPY", "CMP", "DEC", "CMP",
+	"INY", "CMP", "DEX", "WAI", "CPY", "CMP", "DEC", "CMP",
+	"BNE", "CMP", "CMP", "CMP", "PEI", "CMP", "DEC", "CMP",
+	"CLD", "CMP", "PHX", "STP", "JML", "CMP", "DEC", "CMP",
+	"CPX", "SBC", "SEP", "SBC", "CPX", "SBC", "INC", "SBC",
+	"INX", "SBC", "NOP", "XBA", "CPX", "SBC", "INC", "SBC",
+	"BEQ", "SBC", "SBC", "SBC", "PEA", "SBC", "INC", "SBC",
+	"SED", "SBC", "PLX", "XCE", "JSR", "SBC", "INC", "SBC"
+};
+
+struct SProfilePC
+{
+	uint32	PC;
+	uint64	Cycles;
+	uint32	Count;
+};
+
+void S9xProfileCharge (struct SProfiler *p, uint64 clock)
+{
+	// a reset or snapshot moved the clock back; nothing sensible to charge
+	if (clock < p->Last)
+		return;
+
+	uint64					cycles = clock - p->Last;
+	struct SProfileEntry	*bank = p->Banks[p->PC >> 16];
+
+	if (!bank)
+	{
+		bank = p->Banks[p->PC >> 16] = (struct SProfileEntry *) calloc(0x10000, sizeof(struct SProfileEntry));
+		if (!bank)
+			return;
+	}
+
+	p->Ops[p->Op].Count++;
+	p->Ops[p->Op].Cycles += cycles;
+	bank[p->PC & 0xffff].Count++;
+	bank[p->PC & 0xffff].Cycles += cycles;
+}
+
+static void S9xProfileClear (struct SProfiler *p)
+{
+	for (int i = 0; i < 256; i++)
+		free(p->Banks[i]);
+
+	memset(p, 0, sizeof(struct SProfiler));
+}
+
+void S9xProfileReset (void)
+{
+	S9xProfileClear(&CPUProfile);
+	S9xProfileClear(&SA1Profile);
+}
+
+// after a snapshot load the next instruction starts a new measurement
+void S9xProfileResync (void)
+{
+	CPUProfile.Running = FALSE;
+	SA1Profile.Running = FALSE;
+}
+
+static bool ProfileByCycles (const struct SProfilePC &a, const struct SProfilePC &b)
+{
+	return (a.Cycles > b.Cycles || (a.Cycles == b.Cycles && a.PC < b.PC));
+}
+
+static void S9xProfileWrite (FILE *fp, const char *name, struct SProfiler *p, int divisor)
+{
+	std::vector<struct SProfilePC>	pcs;
+	uint64	total = 0, count = 0;
+	int		order[256];
+
+	for (int i = 0; i < 256; i++)
+	{
+		total += p->Ops[i].Cycles;
+		count += p->Ops[i].Count;
+		order[i] = i;
+	}
+
+	if (!count)
+		return;
+
+	for (int b = 0; b < 256; b++)
+	{
+		if (!p->Banks[b])
+			continue;
+
+		for (int a = 0; a < 0x10000; a++)
+		{
+			struct SProfileEntry	*e = &p->Banks[b][a];
+
+			if (e->Count)
+			{
+				struct SProfilePC	pc = { (uint32) (b << 16 | a), e->Cycles, e->Count };
+				pcs.push_back(pc);
+			}
+		}
+	}
+
+	fprintf(fp, "%s: %llu instructions, %llu master cycles, %u addresses\n\n", name,
+		(unsigned long long) count, (unsigned long long) (total / divisor), (unsigned) pcs.size());
+
+	std::sort(order, order + 256, [p](int a, int b) { return (p->Ops[a].Cycles > p->Ops[b].Cycles || (p->Ops[a].Cycles == p->Ops[b].Cycles && a < b)); });
+
+	fprintf(fp, "%s opcodes by cycles\n  op mnem        count           cycles      %%  cyc/op\n", name);
+	for (int i = 0; i < 256 && p->Ops[order[i]].Count; i++)
+	{
+		struct SProfileEntry	*e = &p->Ops[order[i]];
+
+		fprintf(fp, "  %02X %s %12u %16llu %6.2f %7.2f\n", order[i], ProfileMnemonics[order[i]], e->Count,
+			(unsigned long long) (e->Cycles / divisor), 100.0 * e->Cycles / total, (double) e->Cycles / divisor / e->Count);
+	}
+
+	std::vector<struct SProfilePC>	sorted(pcs);
+	std::sort(sorted.begin(), sorted.end(), ProfileByCycles);
+
+	fprintf(fp, "\n%s addresses by cycles (top %d)\n  address        count           cycles      %%\n", name, PROFILE_TOP_PCS);
+	for (size_t i = 0; i < sorted.size() && i < PROFILE_TOP_PCS; i++)
+		fprintf(fp, "  %02X:%04X %12u %16llu %6.2f\n", sorted[i].PC >> 16, sorted[i].PC & 0xffff, sorted[i].Count,
+			(unsigned long long) (sorted[i].Cycles / divisor), 100.0 * sorted[i].Cycles / total);
+
+	fprintf(fp, "\n%s opcodes\n  op mnem        count           cycles\n", name);
+	for (int i = 0; i < 256; i++)
+		fprintf(fp, "  %02X %s %12u %16llu\n", i, ProfileMnemonics[i], p->Ops[i].Count, (unsigned long long) (p->Ops[i].Cycles / divisor));
+
+	fprintf(fp, "\n%s addresses\n  address        count           cycles\n", name);
+	for (size_t i = 0; i < pcs.size(); i++)
+		fprintf(fp, "  %02X:%04X %12u %16llu\n", pcs[i].PC >> 16, pcs[i].PC & 0xffff, pcs[i].Count, (unsigned long long) (pcs[i].Cycles / divisor));
+
+	fprintf(fp, "\n");
+}
+
+// Writes the sorted reports first and the flat tables after them; the SA-1 section only when it ran.
+bool8 S9xProfileReport (const char *filename)
+{
+	FILE	*fp = fopen(filename, "w");
+
+	if (!fp)
+		return (FALSE);
+
+	S9xProfileWrite(fp, "CPU", &CPUProfile, 1);
+	// SA1.Cycles run at three times the master clock
+	S9xProfileWrite(fp, "SA-1", &SA1Profile, 3);
+
+	fclose(fp);
+
+	return (TRUE);
+}
+
+#endif
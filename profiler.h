@@ -0,0 +1,61 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#ifdef CPU_PROFILER
+
+struct SProfileEntry
+{
+	uint64	Cycles;
+	uint32	Count;
+};
+
+// Each instruction is charged when the next one starts, with everything in between: its own cycles, any DMA it
+// started, and the entry of an interrupt taken right after it. Clocks are in the processor's own cycle units,
+// made monotonic by Base, which collects what the line ends take off.
+struct SProfiler
+{
+	uint64					Base;
+	uint64					Last;
+	uint32					PC;
+	uint8					Op;
+	bool8					Running;
+	struct SProfileEntry	Ops[256];
+	struct SProfileEntry	*Banks[256];	// 64K entries each, allocated on first use
+};
+
+extern S9X_TLS struct SProfiler	CPUProfile;
+extern S9X_TLS struct SProfiler	SA1Profile;
+
+void S9xProfileCharge (struct SProfiler *, uint64);
+void S9xProfileReset (void);
+void S9xProfileResync (void);
+bool8 S9xProfileReport (const char *);
+
+static inline void S9xProfileOp (struct SProfiler *p, uint64 clock, uint32 pc, uint8 op)
+{
+	if (p->Running)
+		S9xProfileCharge(p, clock);
+
+	p->Last = clock;
+	p->PC = pc & 0xffffff;
+	p->Op = op;
+	p->Running = TRUE;
+}
+
+#define PROFILE_OP(p, cycles, pc, op)	S9xProfileOp(&(p), (p).Base + (cycles), (pc), (op))
+#define PROFILE_LINE(p, cycles)			{ (p).Base += (cycles); }
+
+#else
+
+#define PROFILE_OP(p, cycles, pc, op)	{}
+#define PROFILE_LINE(p, cycles)			{}
+
+#endif
+
+#endif
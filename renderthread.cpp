@@ -0,0 +1,469 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifdef S9X_THREADED_RENDER
+
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "snes9x.h"
+#include "memmap.h"
+#include "ppu.h"
+#include "controls.h"
+#include "crosshairs.h"
+#include "cheats.h"
+#include "movie.h"
+#include "screenshot.h"
+#include "display.h"
+#include "simd.h"
+#include "renderthread.h"
+
+// Every S9xUpdateScreen on the emulation thread becomes a job holding what the renderer reads, as it was at that
+// moment, and the render thread runs the same S9xUpdateScreen on its own copy of the renderer's globals (see
+// RenderCopy below). Jobs draw line ranges of one shared screen and a later range can widen the earlier ones, so
+// they run strictly in order on a single thread; the emulation thread only waits for it when the frame is handed
+// to the port, or when the queue is full.
+
+#define RENDER_THREAD_JOBS	8
+
+extern S9X_TLS struct SLineData			LineData[240];
+extern S9X_TLS struct SLineMatrixData	LineMatrixData[240];
+
+S9X_TLS uint64	RenderThreadVRAMDirty;
+
+struct SRenderJob
+{
+	bool8	NewFrame;
+	bool8	Colours;
+
+	struct SPPU	PPU;
+
+	struct
+	{
+		bool8	OBJChanged;
+		uint64	OBJDirty[2];
+		bool8	Interlace;
+		bool8	InterlaceOBJ;
+		bool8	PseudoHires;
+		bool8	DoubleWidthPixels;
+		bool8	DoubleHeightPixels;
+		int		CurrentLine;
+		int		PreviousLine;
+		uint8	*XB;
+		uint16	ScreenColors[256];
+		uint8	MaxBrightness;
+		int		RenderedScreenWidth;
+		int		RenderedScreenHeight;
+	}	IPPU;
+
+	uint16	*Screen;
+	uint32	PPL;
+	uint8	DoInterlace;
+
+	uint8	Registers[0x100];	// $2100-$21FF
+
+	struct SLineData		LineData[240];
+	struct SLineMatrixData	LineMatrixData[240];
+
+	// only when the brightness changed
+	uint16	DirectColourMaps[8][256];
+	uint8	BrightnessCap[64];
+
+	// only at the start of a frame
+	struct SSettings	Settings;
+
+	uint64	VRAMDirty;
+	uint8	VRAM[0x10000];
+};
+
+struct SRenderThread
+{
+	std::thread				Thread;
+	std::mutex				Lock;
+	std::condition_variable	Queued;
+	std::condition_variable	Done;
+	uint32					Head;
+	uint32					Count;
+	bool8					Quit;
+	bool8					Failed;
+	bool8					NewFrame;
+	uint8					*XB;
+	struct SRenderJob		Jobs[RENDER_THREAD_JOBS];
+};
+
+static S9X_TLS struct SRenderThread	*RenderThread = NULL;
+
+static const uint32	TileCacheSize[7] =
+{
+	MAX_2BIT_TILES,	// TILE_2BIT
+	MAX_4BIT_TILES,	// TILE_4BIT
+	MAX_8BIT_TILES,	// TILE_8BIT
+	MAX_2BIT_TILES,	// TILE_2BIT_EVEN
+	MAX_2BIT_TILES,	// TILE_2BIT_ODD
+	MAX_4BIT_TILES,	// TILE_4BIT_EVEN
+	MAX_4BIT_TILES	// TILE_4BIT_ODD
+};
+
+// The renderer is built a second time in here, inside a namespace that declares its own PPU, IPPU, GFX and the rest of
+// what it reads. Name lookup finds those before the globals, so this copy draws from state only the render thread
+// touches, and neither thread pays for thread_local on every access the way an S9X_MULTI_INSTANCE build does.
+// Everything else it calls, and what the headers included above define, is still the emulation thread's; of that the
+// renderer only reads tables that never change, such as GFX.ZERO in COLOR_SUB.
+
+namespace RenderCopy {
+
+S9X_TLS struct SPPU				PPU;
+S9X_TLS struct InternalPPU		IPPU;
+S9X_TLS struct SGFX				GFX;
+S9X_TLS struct SBG				BG;
+S9X_TLS struct SLineData		LineData[240];
+S9X_TLS struct SLineMatrixData	LineMatrixData[240];
+S9X_TLS uint16					BlackColourMap[256];
+S9X_TLS uint16					DirectColourMaps[8][256];
+S9X_TLS uint8					brightness_cap[64];
+S9X_TLS struct SSettings		Settings;
+
+// as much of CMemory as the renderer uses
+S9X_TLS struct
+{
+	uint8	VRAM[0x10000];
+	uint8	*FillRAM;
+	int32	ROMFramesPerSecond;
+}	Memory;
+
+// memmap.h's reads the emulation thread's $213F
+static inline bool S9xInterlaceField (void)
+{
+	return (Memory.FillRAM[0x213F] & 0x80) >> 7;
+}
+
+// gfx.cpp calls these before it defines them, and the declarations in gfx.h and ppu.h name the emulation thread's
+void S9xGraphicsDeinit (void);
+void S9xBuildDirectColourMaps (void);
+void S9xUpdateScreen (void);
+void S9xDisplayMessages (uint16 *, int, int, int, int);
+
+// the colours come with the jobs; the emulation thread's S9xFixColourBrightness would write its own
+static void S9xFixColourBrightness (void)
+{
+}
+
+#undef S9X_THREADED_RENDER
+#define _TILEIMPL_CPP_
+#include "gfx.cpp"
+#include "clip.cpp"
+#include "tile.cpp"
+#include "tileimpl-n1x1.cpp"
+#include "tileimpl-n2x1.cpp"
+#include "tileimpl-h2x1.cpp"
+#undef _TILEIMPL_CPP_
+#define S9X_THREADED_RENDER
+
+// the render thread's side
+
+static void S9xRenderThreadDeinitGraphics (void)
+{
+	S9xGraphicsDeinit();
+
+	for (int t = 0; t < 7; t++)
+	{
+		free(IPPU.TileCache[t]);
+		free(IPPU.TileCached[t]);
+		IPPU.TileCache[t] = IPPU.TileCached[t] = NULL;
+	}
+
+	free(Memory.FillRAM);
+	Memory.FillRAM = NULL;
+}
+
+static bool8 S9xRenderThreadInitGraphics (void)
+{
+	if (!S9xGraphicsInit())
+		return (FALSE);
+
+	// the emulation thread's screen is drawn into, never this thread's own
+	std::vector<uint16>().swap(GFX.ScreenBuffer);
+
+	bool8	ok = TRUE;
+
+	for (int t = 0; t < 7; t++)
+	{
+		IPPU.TileCache[t]  = (uint8 *) malloc(TileCacheSize[t] * 64);
+		IPPU.TileCached[t] = (uint8 *) calloc(TileCacheSize[t], 1);
+		if (!IPPU.TileCache[t] || !IPPU.TileCached[t])
+			ok = FALSE;
+	}
+
+	// only $2100-$21FF is ever filled in
+	Memory.FillRAM = (uint8 *) calloc(0x2200, 1);
+	if (!Memory.FillRAM)
+		ok = FALSE;
+
+	S9xResetTileCache();
+
+	if (!ok)
+		S9xRenderThreadDeinitGraphics();
+
+	return (ok);
+}
+
+// As if REGISTER_2118 and REGISTER_2119 had written every byte of the block.
+static void S9xRenderThreadInvalidateVRAM (uint32 block)
+{
+	IPPU.VRAMDirty[block] = ~(uint64) 0;
+	IPPU.VRAMDirtyWords |= (uint64) 1 << block;
+}
+
+static void S9xRenderThreadRun (struct SRenderJob *job)
+{
+	if (job->NewFrame)
+	{
+		Settings = job->Settings;
+		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
+		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
+	}
+
+	for (uint32 b = 0; b < 64; b++)
+	{
+		if (job->VRAMDirty & ((uint64) 1 << b))
+		{
+			memcpy(Memory.VRAM + (b << 10), job->VRAM + (b << 10), 0x400);
+			S9xRenderThreadInvalidateVRAM(b);
+		}
+	}
+
+	PPU = job->PPU;
+
+	IPPU.OBJChanged           = job->IPPU.OBJChanged || job->NewFrame;	// OAM may have changed in skipped frames
+	IPPU.OBJDirty[0]          = job->NewFrame ? ~(uint64) 0 : job->IPPU.OBJDirty[0];
+	IPPU.OBJDirty[1]          = job->NewFrame ? ~(uint64) 0 : job->IPPU.OBJDirty[1];
+	IPPU.Interlace            = job->IPPU.Interlace;
+	IPPU.InterlaceOBJ         = job->IPPU.InterlaceOBJ;
+	IPPU.PseudoHires          = job->IPPU.PseudoHires;
+	IPPU.DoubleWidthPixels    = job->IPPU.DoubleWidthPixels;
+	IPPU.DoubleHeightPixels   = job->IPPU.DoubleHeightPixels;
+	IPPU.CurrentLine          = job->IPPU.CurrentLine;
+	IPPU.PreviousLine         = job->IPPU.PreviousLine;
+	IPPU.XB                   = job->IPPU.XB;
+	IPPU.MaxBrightness        = job->IPPU.MaxBrightness;
+	IPPU.RenderedScreenWidth  = job->IPPU.RenderedScreenWidth;
+	IPPU.RenderedScreenHeight = job->IPPU.RenderedScreenHeight;
+	IPPU.RenderThisFrame      = TRUE;
+	memcpy(IPPU.ScreenColors, job->IPPU.ScreenColors, sizeof(IPPU.ScreenColors));
+
+	if (job->Colours)
+	{
+		memcpy(DirectColourMaps, job->DirectColourMaps, sizeof(DirectColourMaps));
+		memcpy(brightness_cap, job->BrightnessCap, sizeof(brightness_cap));
+	}
+
+	GFX.Screen = job->Screen;
+	GFX.PPL = job->PPL;
+	GFX.DoInterlace = job->DoInterlace;
+
+	memcpy(Memory.FillRAM + 0x2100, job->Registers, 0x100);
+
+	int	last = IPPU.CurrentLine < 240 ? IPPU.CurrentLine : 240;
+	if (IPPU.PreviousLine < last)
+	{
+		memcpy(LineData + IPPU.PreviousLine, job->LineData + IPPU.PreviousLine, (last - IPPU.PreviousLine) * sizeof(struct SLineData));
+		memcpy(LineMatrixData + IPPU.PreviousLine, job->LineMatrixData + IPPU.PreviousLine, (last - IPPU.PreviousLine) * sizeof(struct SLineMatrixData));
+	}
+
+	S9xUpdateScreen();
+}
+
+static void S9xRenderThreadMain (struct SRenderThread *rt)
+{
+	bool8	ok = S9xRenderThreadInitGraphics();
+
+	std::unique_lock<std::mutex>	lock(rt->Lock);
+
+	for (;;)
+	{
+		rt->Queued.wait(lock, [rt] { return (rt->Count || rt->Quit); });
+		if (!rt->Count)
+			break;
+
+		lock.unlock();
+
+		// without its buffers the thread still empties the queue, so the emulation thread never waits forever
+		if (ok)
+			S9xRenderThreadRun(&rt->Jobs[rt->Head]);
+
+		lock.lock();
+
+		rt->Head = (rt->Head + 1) % RENDER_THREAD_JOBS;
+		rt->Count--;
+		rt->Failed |= !ok;
+		rt->Done.notify_all();
+	}
+
+	lock.unlock();
+
+	if (ok)
+		S9xRenderThreadDeinitGraphics();
+}
+
+} // namespace RenderCopy
+
+// the emulation thread's side
+
+bool8 S9xRenderThreadStart (void)
+{
+	if (RenderThread)
+		return (TRUE);
+
+	struct SRenderThread	*rt = new (std::nothrow) SRenderThread();
+	if (!rt)
+		return (FALSE);
+
+	rt->NewFrame = TRUE;
+	RenderThreadVRAMDirty = ~(uint64) 0;
+
+	rt->Thread = std::thread(RenderCopy::S9xRenderThreadMain, rt);
+	RenderThread = rt;
+
+	return (TRUE);
+}
+
+void S9xRenderThreadStop (void)
+{
+	struct SRenderThread	*rt = RenderThread;
+
+	if (!rt)
+		return;
+
+	{
+		std::lock_guard<std::mutex>	lock(rt->Lock);
+		rt->Quit = TRUE;
+	}
+
+	rt->Queued.notify_one();
+	rt->Thread.join();
+
+	RenderThread = NULL;
+	delete rt;
+
+	// clip windows were only kept up to date on the render thread
+	PPU.RecomputeClipWindows = TRUE;
+}
+
+bool8 S9xRenderThreadActive (void)
+{
+	return (RenderThread != NULL);
+}
+
+void S9xRenderThreadNewFrame (void)
+{
+	if (RenderThread)
+		RenderThread->NewFrame = TRUE;
+}
+
+void S9xRenderThreadSync (void)
+{
+	struct SRenderThread	*rt = RenderThread;
+
+	if (!rt)
+		return;
+
+	std::unique_lock<std::mutex>	lock(rt->Lock);
+	rt->Done.wait(lock, [rt] { return (!rt->Count); });
+
+	if (rt->Failed)
+	{
+		lock.unlock();
+		S9xRenderThreadStop();
+		S9xMessage(S9X_ERROR, S9X_ROM_INFO, "Render thread could not allocate its buffers, drawing on the emulation thread.");
+	}
+}
+
+// Called at the start of S9xUpdateScreen. Returns FALSE when there is no render thread and the caller draws.
+bool8 S9xRenderThreadQueue (void)
+{
+	struct SRenderThread	*rt = RenderThread;
+
+	if (!rt)
+		return (FALSE);
+
+	uint32	slot;
+
+	{
+		std::unique_lock<std::mutex>	lock(rt->Lock);
+		rt->Done.wait(lock, [rt] { return (rt->Count < RENDER_THREAD_JOBS); });
+		slot = (rt->Head + rt->Count) % RENDER_THREAD_JOBS;
+	}
+
+	// the render thread leaves a slot alone until Count includes it
+	struct SRenderJob	*job = &rt->Jobs[slot];
+
+	job->NewFrame = rt->NewFrame;
+	if (rt->NewFrame)
+	{
+		job->Settings = Settings;
+		rt->NewFrame = FALSE;
+	}
+
+	job->PPU = PPU;
+
+	job->IPPU.OBJChanged           = IPPU.OBJChanged;
+	job->IPPU.OBJDirty[0]          = IPPU.OBJDirty[0];
+	job->IPPU.OBJDirty[1]          = IPPU.OBJDirty[1];
+	job->IPPU.Interlace            = IPPU.Interlace;
+	job->IPPU.InterlaceOBJ         = IPPU.InterlaceOBJ;
+	job->IPPU.PseudoHires          = IPPU.PseudoHires;
+	job->IPPU.DoubleWidthPixels    = IPPU.DoubleWidthPixels;
+	job->IPPU.DoubleHeightPixels   = IPPU.DoubleHeightPixels;
+	job->IPPU.CurrentLine          = IPPU.CurrentLine;
+	job->IPPU.PreviousLine         = IPPU.PreviousLine;
+	job->IPPU.XB                   = IPPU.XB;
+	job->IPPU.MaxBrightness        = IPPU.MaxBrightness;
+	job->IPPU.RenderedScreenWidth  = IPPU.RenderedScreenWidth;
+	job->IPPU.RenderedScreenHeight = IPPU.RenderedScreenHeight;
+	memcpy(job->IPPU.ScreenColors, IPPU.ScreenColors, sizeof(IPPU.ScreenColors));
+
+	// S9xFixColourBrightness and S9xBuildDirectColourMaps always run together and set XB
+	job->Colours = IPPU.XB != rt->XB;
+	if (job->Colours)
+	{
+		memcpy(job->DirectColourMaps, DirectColourMaps, sizeof(DirectColourMaps));
+		memcpy(job->BrightnessCap, brightness_cap, sizeof(brightness_cap));
+		rt->XB = IPPU.XB;
+	}
+
+	job->Screen = GFX.Screen;
+	job->PPL = GFX.PPL;
+	job->DoInterlace = GFX.DoInterlace;
+
+	memcpy(job->Registers, Memory.FillRAM + 0x2100, 0x100);
+
+	int	last = IPPU.CurrentLine < 240 ? IPPU.CurrentLine : 240;
+	if (IPPU.PreviousLine < last)
+	{
+		memcpy(job->LineData + IPPU.PreviousLine, LineData + IPPU.PreviousLine, (last - IPPU.PreviousLine) * sizeof(struct SLineData));
+		memcpy(job->LineMatrixData + IPPU.PreviousLine, LineMatrixData + IPPU.PreviousLine, (last - IPPU.PreviousLine) * sizeof(struct SLineMatrixData));
+	}
+
+	job->VRAMDirty = RenderThreadVRAMDirty;
+	for (uint32 b = 0; b < 64; b++)
+	{
+		if (RenderThreadVRAMDirty & ((uint64) 1 << b))
+			memcpy(job->VRAM + (b << 10), Memory.VRAM + (b << 10), 0x400);
+	}
+	RenderThreadVRAMDirty = 0;
+
+	{
+		std::lock_guard<std::mutex>	lock(rt->Lock);
+		rt->Count++;
+	}
+
+	rt->Queued.notify_one();
+
+	return (TRUE);
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef _RENDERTHREAD_H_
+#define _RENDERTHREAD_H_
+
+#ifdef S9X_THREADED_RENDER
+
+// lines handed over at once when no register write has flushed them earlier
+#define RENDER_THREAD_BATCH	16
+
+// VRAM written since the last batch was handed over, one bit per 1K
+extern S9X_TLS uint64	RenderThreadVRAMDirty;
+
+bool8 S9xRenderThreadStart (void);
+void S9xRenderThreadStop (void);
+bool8 S9xRenderThreadActive (void);
+bool8 S9xRenderThreadQueue (void);
+void S9xRenderThreadNewFrame (void);
+void S9xRenderThreadSync (void);
+
+#define RENDER_THREAD_VRAM_WRITE(address)	{ RenderThreadVRAMDirty |= (uint64) 1 << ((address) >> 10); }
+#define RENDER_THREAD_VRAM_RESET()			{ RenderThreadVRAMDirty = ~(uint64) 0; }
+
+#else
+
+#define RENDER_THREAD_VRAM_WRITE(address)	{}
+#define RENDER_THREAD_VRAM_RESET()			{}
+
+#endif
+
+#endif
@@ -0,0 +1,225 @@
+/*
+rexbench - measures REX interpreter throughput against a synthetic memory map.
+
+	usage: rexbench [-c] [-n vms] [-t seconds]
+
+	each program below loops forever doing mostly one class of work; rexbench runs it in fixed budget
+	slices and reports the wall time per executed op. budget a fused poll fast-forwards through instead
+	of going round its loop is not an executed op, and is shown on its own in the skipped column. -c forces the checked interpreter instead of the
+	verified one, and -n also runs the arith program on a pool of that many VMs through rex_exec_slice().
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rex.h"
+#include "rex_compile.h"
+
+#define BENCH_SLICE 4096
+
+static const struct bench {
+	const char *name;
+	const char *src;
+} benches[] = {
+	{ "chip-read-u8",
+		"(fn-start) (lbl 0)"
+		" (xor (chip-read-u8 #WRAM 0) (chip-read-u8 #WRAM 1))"
+		" (jmp 0)" },
+	{ "arith",
+		"(fn-start) (lbl 0)"
+		" (xor (add (chip-read-u24 #WRAM 0) (chip-read-u24 #WRAM 3))"
+		"      (sub (shl (chip-read-u24 #WRAM 6) 3) (and (chip-read-u24 #WRAM 9) FFFF)))"
+		" (jmp 0)" },
+	{ "compare-branch",
+		"(fn-start) (lbl 0)"
+		" (jeq (lt-u (chip-read-u16 #WRAM 0) 1000) 1)"
+		" (jne (ge-s (chip-read-u16 #WRAM 2) 0) 0)"
+		" (lbl 1)"
+		" (jmp 0)" },
+	{ "vec-assign",
+		"(def-vec &0 40) (fn-start) (lbl 0)"
+		" (vec-assign &0 $00112233_44556677_8899AABB_CCDDEEFF (chip-read-u8 #WRAM 0))"
+		" (jmp 0)" },
+	{ "chip-read",
+		"(def-vec &0 20) (def-vec &30 20) (fn-start) (lbl 0)"
+		" (chip-read #WRAM 100 20 &0 &30)"
+		" (jmp 0)" },
+	{ "chip-write",
+		"(def-vec &0 40) (fn-start) (chip-read #ROM 0 40 &0) (lbl 0)"
+		" (chip-write #WRAM 1000 &0)"
+		" (chip-write-u16 #SRAM 10 (chip-read-u16 #WRAM 1000))"
+		" (jmp 0)" },
+	{ "rsp-write-vec",
+		"(def-vec &0 20) (fn-start) (chip-read #WRAM 0 20 &0) (lbl 0)"
+		" (rsp-write-vec &0 $CAFE)"
+		" (jmp 0)" },
+	{ "read-rsp (fused)",
+		"(def-vec &0 20) (fn-start) (lbl 0)"
+		" (chip-read #WRAM 0 20 &0)"
+		" (rsp-write-vec &0)"
+		" (jmp 0)" },
+	{ "poll (fused)",
+		"(fn-start) (lbl 0)"
+		" (jne (chip-read-u8 #2C00 0) 0)"
+		" (jmp 0)" },
+};
+
+static uint8_t wram[0x20000];
+static uint8_t sram[0x8000];
+static uint8_t rom[0x100000];
+static uint8_t io[0x200];
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void drain(struct rex_vm *vm)
+{
+	uint8_t buf[REX_VM_MEMSZ + 8];
+
+	while (rex_vm_rsp_read(vm, buf, sizeof(buf)) > 0)
+		;
+}
+
+static void map_chips(void)
+{
+	for (size_t i = 0; i < sizeof(wram); i++)
+		wram[i] = (uint8_t)(i * 7);
+	for (size_t i = 0; i < sizeof(rom); i++)
+		rom[i] = (uint8_t)(i >> 3);
+
+	// the poll bench spins on $2C00 the way a VM waits for the SNES side:
+	io[0] = 1;
+
+	rex_set_chip(REX_CHIP_WRAM, wram, sizeof(wram), 1);
+	rex_set_chip(REX_CHIP_SRAM, sram, sizeof(sram), 1);
+	rex_set_chip(REX_CHIP_ROM, rom, sizeof(rom), 0);
+	rex_set_chip(REX_CHIP_2C00, io, sizeof(io), 1);
+}
+
+static int compile(const struct bench *b, uint8_t *prog, size_t *len)
+{
+	struct rex_compile_error err;
+
+	if (rex_compile(b->src, strlen(b->src), prog, REX_VM_MEMSZ, len, &err) < 0) {
+		fprintf(stderr, "%s: %d:%d: %s\n", b->name, err.line, err.col, err.msg);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void run_single(const struct bench *b, int checked, double seconds)
+{
+	static struct rex_vm vm;
+	uint8_t  prog[REX_VM_MEMSZ];
+	size_t   len;
+	uint64_t ops = 0, skipped = 0;
+	double   t = 0, t0;
+
+	if (compile(b, prog, &len) < 0)
+		return;
+
+	rex_vm_init(&vm);
+	if (rex_vm_load(&vm, prog, (uint16_t)len) != REX_VM_ERR_NONE) {
+		fprintf(stderr, "%s: load failed\n", b->name);
+		return;
+	}
+
+	// put back the program as encoded, undoing any fusion, and drop the verifier's guarantee:
+	if (checked) {
+		memcpy(vm.m, prog, len);
+		vm.verified = 0;
+		vm.nfused = 0;
+	}
+
+	while (t < seconds) {
+		t0 = now();
+		for (int i = 0; i < 64; i++) {
+			if (rex_vm_exec(&vm, BENCH_SLICE) >= REX_VM_HALTED) {
+				fprintf(stderr, "%s: stopped with status %d err %d\n", b->name, vm.status, vm.err);
+				return;
+			}
+			ops += vm.ops - vm.skipped;
+			skipped += vm.skipped;
+		}
+		t += now() - t0;
+		drain(&vm);
+	}
+
+	printf("%-20s %c %12llu %12llu %9.2f\n", b->name, checked ? 'c' : 'v', (unsigned long long)ops, (unsigned long long)skipped, t * 1e9 / (double)ops);
+}
+
+static void run_pool(const struct bench *b, int count, double seconds)
+{
+	uint8_t  prog[REX_VM_MEMSZ];
+	size_t   len;
+	uint64_t ops = 0, skipped = 0;
+	uint32_t line = 0;
+	double   t = 0, t0;
+
+	if (compile(b, prog, &len) < 0 || rex_set_count((uint32_t)count) < 0)
+		return;
+
+	rex_init();
+	// one VM op per master cycle so a 1364 cycle scanline hands out 1364 ops:
+	rex_set_clock_ratio(1, 1);
+	for (int i = 0; i < count; i++) {
+		rex_load(i, prog, (uint16_t)len);
+		rex_set_budget(i, 1364 / count);
+	}
+
+	while (t < seconds) {
+		t0 = now();
+		for (int i = 0; i < 262; i++) {
+			rex_exec_slice(1364, line);
+			for (int k = 0; k < count; k++) {
+				ops += rex.task[k].vm.ops - rex.task[k].vm.skipped;
+				skipped += rex.task[k].vm.skipped;
+			}
+			line = (line + 1) % 262;
+		}
+		t += now() - t0;
+	}
+
+	printf("%-20s %c %12llu %12llu %9.2f   (%d VMs, pool)\n", b->name, 'v', (unsigned long long)ops, (unsigned long long)skipped, t * 1e9 / (double)ops, count);
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: rexbench [-c] [-n vms] [-t seconds]\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	int    checked = 0, pool = 0;
+	double seconds = 0.25;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-c"))
+			checked = 1;
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			pool = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+			seconds = atof(argv[++i]);
+		else
+			usage();
+	}
+
+	map_chips();
+
+	printf("%-20s %c %12s %12s %9s\n", "class", ' ', "ops", "skipped", "ns/op");
+	for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+		run_single(&benches[i], checked, seconds);
+
+	if (pool > 0)
+		run_pool(&benches[1], pool, seconds);
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+/*
+rexc - compiles REX source (see rex_vm.h) into the serialized binary format.
+
+	usage: rexc [-o output] [-x] input
+
+	input may be `-` for stdin. without -o the program is written to stdout as hex.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rex_compile.h"
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: rexc [-o output] [-x] input\n");
+	fprintf(stderr, "  -o output   write the binary program to output\n");
+	fprintf(stderr, "  -x          also print the program as hex on stdout\n");
+	exit(2);
+}
+
+static char *read_all(const char *path, size_t *len)
+{
+	FILE   *f = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+	char   *buf = NULL;
+	size_t  cap = 0, n = 0;
+
+	if (!f)
+		return NULL;
+
+	for (;;) {
+		size_t got;
+		if (n == cap) {
+			char *b;
+			cap = cap ? cap * 2 : 4096;
+			b = (char *)realloc(buf, cap);
+			if (!b) {
+				free(buf);
+				buf = NULL;
+				break;
+			}
+			buf = b;
+		}
+		got = fread(buf + n, 1, cap - n, f);
+		n += got;
+		if (got == 0)
+			break;
+	}
+
+	if (f != stdin)
+		fclose(f);
+
+	*len = n;
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	const char *input = NULL, *output = NULL;
+	int         hex = 0;
+	char       *src;
+	size_t      srclen, len;
+	uint8_t     prog[REX_VM_MEMSZ];
+	struct rex_compile_error err;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			output = argv[++i];
+		else if (!strcmp(argv[i], "-x"))
+			hex = 1;
+		else if (argv[i][0] == '-' && argv[i][1])
+			usage();
+		else if (!input)
+			input = argv[i];
+		else
+			usage();
+	}
+
+	if (!input)
+		usage();
+	if (!output)
+		hex = 1;
+
+	src = read_all(input, &srclen);
+	if (!src) {
+		perror(input);
+		return 1;
+	}
+
+	if (rex_compile(src, srclen, prog, sizeof(prog), &len, &err) < 0) {
+		if (err.line)
+			fprintf(stderr, "%s:%d:%d: %s\n", input, err.line, err.col, err.msg);
+		else
+			fprintf(stderr, "%s: %s\n", input, err.msg);
+		free(src);
+		return 1;
+	}
+	free(src);
+
+	if (output) {
+		FILE *f = fopen(output, "wb");
+		if (!f || fwrite(prog, 1, len, f) != len) {
+			perror(output);
+			if (f)
+				fclose(f);
+			return 1;
+		}
+		fclose(f);
+	}
+
+	if (hex) {
+		for (size_t i = 0; i < len; i++)
+			printf("%02X%c", prog[i], (i % 16 == 15 || i + 1 == len) ? '\n' : ' ');
+	}
+
+	return 0;
+}
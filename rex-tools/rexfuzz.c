@@ -0,0 +1,129 @@
+/*
+rexfuzz - libFuzzer entry point over the REX binary decoder and interpreter.
+
+	every input is loaded as a program and run for a few slices against small chips, so reads and writes
+	near the chip ends are common. programs that pass the verifier also run a second time on the checked
+	interpreter without fusion, and any difference in what the two did aborts.
+
+	built with -DREXFUZZ_MAIN it instead runs each file named on the command line once, which replays a
+	corpus or a crash without libFuzzer.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rex_vm.h"
+
+#define FUZZ_SLICES 16
+
+struct fuzz_chips {
+	uint8_t wram[0x400];
+	uint8_t rom[0x100];
+	uint8_t io[0x200];
+};
+
+static struct rex_vm     vm[2];
+static struct fuzz_chips chips[2];
+
+static void fuzz_map(struct fuzz_chips *c)
+{
+	rex_chips[REX_CHIP_WRAM] = (struct rex_chip){ c->wram, sizeof(c->wram), 1 };
+	rex_chips[REX_CHIP_SRAM] = (struct rex_chip){ NULL, 0, 1 };
+	rex_chips[REX_CHIP_ROM]  = (struct rex_chip){ c->rom, sizeof(c->rom), 0 };
+	rex_chips[REX_CHIP_2C00] = (struct rex_chip){ c->io, sizeof(c->io), 1 };
+}
+
+static void fuzz_reset(struct rex_vm *v, struct fuzz_chips *c)
+{
+	for (size_t i = 0; i < sizeof(c->wram); i++)
+		c->wram[i] = (uint8_t)(i * 13);
+	for (size_t i = 0; i < sizeof(c->rom); i++)
+		c->rom[i] = (uint8_t)~i;
+	memset(c->io, 0, sizeof(c->io));
+
+	// the ring outlives rex_vm_init() by design, so empty it by hand for a clean comparison:
+	memset(&v->rsp, 0, sizeof(v->rsp));
+	rex_vm_init(v);
+}
+
+static int fuzz_step(int i, int slice)
+{
+	uint8_t buf[REX_VM_MEMSZ + 8];
+	int     st;
+
+	fuzz_map(&chips[i]);
+	// the SNES side changes $2C00 now and then so polls get to exit:
+	chips[i].io[0] = (uint8_t)(slice / 4);
+
+	st = rex_vm_exec(&vm[i], 1 + slice * 7 % 61);
+	if (slice & 1)
+		rex_vm_rsp_read(&vm[i], buf, sizeof(buf));
+
+	return st;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	uint16_t len = size > 0xFFFF ? 0xFFFF : (uint16_t)size;
+	int      diff;
+
+	fuzz_reset(&vm[0], &chips[0]);
+	if (rex_vm_load(&vm[0], data, len) != REX_VM_ERR_NONE)
+		return 0;
+
+	if (!vm[0].verified) {
+		for (int s = 0; s < FUZZ_SLICES && fuzz_step(0, s) < REX_VM_HALTED; s++)
+			;
+		return 0;
+	}
+
+	// the same program as encoded, on the checked path:
+	fuzz_reset(&vm[1], &chips[1]);
+	rex_vm_load(&vm[1], data, len);
+	memcpy(vm[1].m, data, len);
+	vm[1].verified = 0;
+	vm[1].nfused = 0;
+
+	for (int s = 0; s < FUZZ_SLICES; s++) {
+		int a = fuzz_step(0, s);
+		int b = fuzz_step(1, s);
+
+		diff = a != b || vm[0].p != vm[1].p || vm[0].err != vm[1].err || vm[0].ops != vm[1].ops ||
+			vm[0].rsp.head != vm[1].rsp.head || vm[0].rsp.dropped != vm[1].rsp.dropped ||
+			memcmp(vm[0].rsp.buf, vm[1].rsp.buf, sizeof(vm[0].rsp.buf)) ||
+			memcmp(&chips[0], &chips[1], sizeof(chips[0]));
+		if (diff) {
+			fprintf(stderr, "rexfuzz: verified and checked runs differ at slice %d (status %d/%d, p %u/%u)\n",
+				s, a, b, vm[0].p, vm[1].p);
+			abort();
+		}
+		if (a >= REX_VM_HALTED)
+			break;
+	}
+
+	return 0;
+}
+
+#ifdef REXFUZZ_MAIN
+int main(int argc, char **argv)
+{
+	static uint8_t buf[0x10000];
+
+	for (int i = 1; i < argc; i++) {
+		FILE  *f = fopen(argv[i], "rb");
+		size_t n;
+
+		if (!f) {
+			perror(argv[i]);
+			return 1;
+		}
+		n = fread(buf, 1, sizeof(buf), f);
+		fclose(f);
+
+		LLVMFuzzerTestOneInput(buf, n);
+	}
+
+	printf("rexfuzz: %d inputs\n", argc - 1);
+	return 0;
+}
+#endif
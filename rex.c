@@ -1,4 +1,318 @@
 
+#include <stdlib.h>
+#include <string.h>
 #include "rex.h"
 
-struct rex_state rex;
+#define REX_DEFAULT_CLOCK_NUM 1
+#define REX_DEFAULT_CLOCK_DEN 8
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define REX_LOAD_ACQUIRE(x)       __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#  define REX_STORE_RELEASE(x, v)   __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#  define REX_CAS(x, old, v)        __atomic_compare_exchange_n(&(x), &(uint32_t){ (old) }, (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#  include <intrin.h>
+#  define REX_LOAD_ACQUIRE(x)       (*(volatile uint32_t *)&(x))
+#  define REX_STORE_RELEASE(x, v)   (*(volatile uint32_t *)&(x) = (v))
+#  define REX_CAS(x, old, v)        (_InterlockedCompareExchange((volatile long *)&(x), (long)(v), (long)(old)) == (long)(old))
+#endif
+
+REX_TLS struct rex_state rex = {
+	.clock_num = REX_DEFAULT_CLOCK_NUM,
+	.clock_den = REX_DEFAULT_CLOCK_DEN,
+};
+
+struct rex_state *rex_instance(void)
+{
+	if (!rex.task)
+		rex_set_count(REX_DEFAULT_VM_COUNT);
+
+	return &rex;
+}
+
+static inline int rex_vm_live(const struct rex_vm *vm)
+{
+	return vm->d != 0 && (vm->status == REX_VM_READY || vm->status == REX_VM_YIELD);
+}
+
+static void rex_task_init(struct rex_task *t)
+{
+	rex_vm_init(&t->vm);
+	t->budget = 0;
+	t->priority = 0;
+	t->enabled = 1;
+	t->park = REX_PARK_NONE;
+	t->park_line = 0;
+}
+
+// rebuilds the run order and the counters the CPU scheduler looks at. only called when a task changes
+// state, never per slice, so the slice loop itself touches runnable VMs and nothing else.
+static void rex_update(void)
+{
+	uint32_t n = 0;
+
+	rex.active = 0;
+	rex.parked_nmi = 0;
+	rex.parked_line = 0;
+
+	for (uint32_t i = 0; i < rex.count; i++) {
+		const struct rex_task *t = &rex.task[i];
+		uint32_t j;
+
+		if (!t->enabled || !rex_vm_live(&t->vm))
+			continue;
+
+		if (t->park == REX_PARK_NMI) {
+			rex.parked_nmi++;
+			continue;
+		}
+
+		rex.active++;
+		if (t->park == REX_PARK_SCANLINE) {
+			rex.parked_line++;
+			continue;
+		}
+
+		// insertion keeps equal priorities in index order:
+		for (j = n; j > 0 && rex.task[rex.order[j - 1]].priority < t->priority; j--)
+			rex.order[j] = rex.order[j - 1];
+		rex.order[j] = i;
+		n++;
+	}
+
+	rex.runnable = n;
+}
+
+static struct rex_task *rex_get(int i)
+{
+	if (!rex.task && rex_set_count(REX_DEFAULT_VM_COUNT) < 0)
+		return NULL;
+
+	if (i < 0 || (uint32_t)i >= rex.count)
+		return NULL;
+
+	return &rex.task[i];
+}
+
+void rex_init(void)
+{
+	rex.clock_num = REX_DEFAULT_CLOCK_NUM;
+	rex.clock_den = REX_DEFAULT_CLOCK_DEN;
+	rex.cycles = 0;
+
+	for (uint32_t i = 0; i < rex.count; i++) {
+		rex_task_init(&rex.task[i]);
+	}
+
+	rex_update();
+}
+
+void rex_set_clock_ratio(uint32_t num, uint32_t den)
+{
+	if (num == 0 || den == 0)
+		return;
+
+	rex.clock_num = num;
+	rex.clock_den = den;
+	rex.cycles = 0;
+}
+
+int rex_set_count(uint32_t count)
+{
+	struct rex_task *task;
+	uint32_t *order;
+
+	if (count == rex.count && rex.task)
+		return 0;
+
+	// the consumer reads straight from rex.task, so it must not be draining while the tasks move:
+	if (!REX_CAS(rex.consumer, REX_RSP_FREE, REX_RSP_RESIZING))
+		return -1;
+
+	task = (struct rex_task *)realloc(rex.task, (count ? count : 1) * sizeof(*task));
+	if (!task) {
+		REX_STORE_RELEASE(rex.consumer, REX_RSP_FREE);
+		return -1;
+	}
+	rex.task = task;
+
+	order = (uint32_t *)realloc(rex.order, (count ? count : 1) * sizeof(*order));
+	if (!order) {
+		// keep the pool consistent at the old size:
+		if (count > rex.count)
+			count = rex.count;
+	} else {
+		rex.order = order;
+	}
+
+	for (uint32_t i = rex.count; i < count; i++) {
+		memset(&rex.task[i].vm.rsp, 0, sizeof(rex.task[i].vm.rsp));
+		rex_task_init(&rex.task[i]);
+	}
+
+	rex.count = count;
+	rex_update();
+
+	REX_STORE_RELEASE(rex.consumer, REX_RSP_FREE);
+
+	return order ? 0 : -1;
+}
+
+int rex_load(int i, const uint8_t *prog, uint16_t len)
+{
+	struct rex_task *t = rex_get(i);
+	int err;
+
+	if (!t)
+		return -1;
+
+	err = rex_vm_load(&t->vm, prog, len);
+	t->park = REX_PARK_NONE;
+	rex_update();
+
+	return err;
+}
+
+void rex_unload(int i)
+{
+	struct rex_task *t = rex_get(i);
+
+	if (!t)
+		return;
+
+	rex_vm_init(&t->vm);
+	t->park = REX_PARK_NONE;
+	rex_update();
+}
+
+void rex_set_budget(int i, int32_t budget)
+{
+	struct rex_task *t = rex_get(i);
+
+	if (t)
+		t->budget = budget > 0 ? budget : 0;
+}
+
+void rex_set_priority(int i, uint8_t priority)
+{
+	struct rex_task *t = rex_get(i);
+
+	if (!t || t->priority == priority)
+		return;
+
+	t->priority = priority;
+	rex_update();
+}
+
+void rex_enable(int i, uint8_t enabled)
+{
+	struct rex_task *t = rex_get(i);
+
+	if (!t || t->enabled == !!enabled)
+		return;
+
+	t->enabled = !!enabled;
+	rex_update();
+}
+
+void rex_park(int i, uint8_t park, uint16_t scanline)
+{
+	struct rex_task *t = rex_get(i);
+
+	if (!t || park > REX_PARK_NMI)
+		return;
+
+	t->park = park;
+	t->park_line = scanline;
+	rex_update();
+}
+
+void rex_signal_nmi(void)
+{
+	if (!rex.parked_nmi)
+		return;
+
+	for (uint32_t i = 0; i < rex.count; i++) {
+		if (rex.task[i].park == REX_PARK_NMI)
+			rex.task[i].park = REX_PARK_NONE;
+	}
+
+	rex_update();
+}
+
+int rex_rsp_attach(struct rex_state *s)
+{
+	if (!s || !REX_CAS(s->consumer, REX_RSP_FREE, REX_RSP_ATTACHED))
+		return -1;
+
+	return 0;
+}
+
+void rex_rsp_detach(struct rex_state *s)
+{
+	if (s && REX_LOAD_ACQUIRE(s->consumer) == REX_RSP_ATTACHED)
+		REX_STORE_RELEASE(s->consumer, REX_RSP_FREE);
+}
+
+int rex_rsp_read(struct rex_state *s, int i, uint8_t *dst, uint32_t cap)
+{
+	if (!s || REX_LOAD_ACQUIRE(s->consumer) != REX_RSP_ATTACHED)
+		return 0;
+
+	if (i < 0 || (uint32_t)i >= s->count)
+		return 0;
+
+	return rex_vm_rsp_read(&s->task[i].vm, dst, cap);
+}
+
+void rex_set_chip(int id, uint8_t *mem, uint32_t size, uint8_t writable)
+{
+	if (id < 0 || id >= REX_CHIP_COUNT)
+		return;
+
+	// offsets are 24-bit so nothing past 16MB is reachable:
+	if (size > 0x1000000)
+		size = 0x1000000;
+
+	rex_chips[id].mem = mem;
+	rex_chips[id].size = mem ? size : 0;
+	rex_chips[id].writable = writable;
+}
+
+void rex_exec_slice(int32_t master_cycles, uint32_t scanline)
+{
+	int32_t budget;
+	int changed = 0;
+
+	rex.cycles += (uint32_t)master_cycles * rex.clock_num;
+	budget = (int32_t)(rex.cycles / rex.clock_den);
+	rex.cycles -= (uint32_t)budget * rex.clock_den;
+
+	// wake VMs parked on this scanline:
+	if (rex.parked_line) {
+		for (uint32_t i = 0; i < rex.count; i++) {
+			struct rex_task *t = &rex.task[i];
+			if (t->park == REX_PARK_SCANLINE && t->park_line == scanline) {
+				t->park = REX_PARK_NONE;
+				changed = 1;
+			}
+		}
+		if (changed) {
+			rex_update();
+			changed = 0;
+		}
+	}
+
+	// execute runnable VMs in priority order until the slice is spent:
+	for (uint32_t k = 0; k < rex.runnable && budget > 0; k++) {
+		struct rex_task *t = &rex.task[rex.order[k]];
+		int32_t b = t->budget && t->budget < budget ? t->budget : budget;
+
+		if (rex_vm_exec(&t->vm, b) >= REX_VM_HALTED)
+			changed = 1;
+		budget -= (int32_t)t->vm.ops;
+	}
+
+	if (changed)
+		rex_update();
+}
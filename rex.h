@@ -1,34 +1,105 @@
-
 #ifndef _REX_H_
 #define _REX_H_
 
 #include <stdint.h>
 #include "rex_vm.h"
 
-#define REX_VM_COUNT 2
+// slots available before rex_set_count() is ever called
+#define REX_DEFAULT_VM_COUNT 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum rex_park {
+	REX_PARK_NONE = 0,
+	REX_PARK_SCANLINE,          // sleeps until the slice for park_line
+	REX_PARK_NMI,               // sleeps until rex_signal_nmi()
+};
+
+struct rex_task {
+	struct rex_vm vm;
+
+	int32_t  budget;            // most ops this VM may take from one slice; 0 = no cap
+	uint8_t  priority;          // higher runs first within a slice
+	uint8_t  enabled;
+	uint8_t  park;              // enum rex_park
+	uint16_t park_line;
+};
 
 struct rex_state {
-	int cycles;
-	int next_exec_cycle;
-	struct rex_vm vm[REX_VM_COUNT];
+	// VM ops per master cycle, as clock_num / clock_den. this is a pace, not a model of the MCU's own clock:
+	// the default of 1/8 gives about 2.7M ops per second on NTSC, and hosts that want scripts to run faster or
+	// slower than that set their own ratio with rex_set_clock_ratio().
+	uint32_t clock_num;
+	uint32_t clock_den;
+	uint32_t cycles;            // leftover master cycles * clock_num not yet turned into VM ops
+
+	uint32_t active;            // tasks that need the scanline tick: runnable or parked on a scanline
+	uint32_t parked_nmi;        // tasks waiting for rex_signal_nmi()
+	uint32_t parked_line;       // tasks waiting for a scanline
+
+	uint32_t count;
+	struct rex_task *task;
+
+	uint32_t runnable;
+	uint32_t *order;            // runnable task indices, highest priority first
+
+	uint32_t consumer;          // enum rex_rsp_owner; see rex_rsp_attach()
 };
 
-extern struct rex_state rex;
+enum rex_rsp_owner {
+	REX_RSP_FREE = 0,
+	REX_RSP_ATTACHED,
+	REX_RSP_RESIZING,
+};
+
+extern REX_TLS struct rex_state rex;
+
+// this thread's instance. with S9X_MULTI_INSTANCE the state is per emulation thread, so a consumer on another
+// thread cannot name `rex` itself; it takes this pointer from the emulation thread and hands it to rex_rsp_read().
+// allocates the default pool if nothing has yet, since the pool cannot be resized once a consumer is attached.
+struct rex_state *rex_instance(void);
+
+void rex_init(void);
+void rex_set_clock_ratio(uint32_t num, uint32_t den);
+
+// resizes the VM pool; existing VMs below count keep their state. returns 0, or -1 if out of memory or while a
+// consumer is attached, since the tasks and their response rings move.
+int  rex_set_count(uint32_t count);
+
+int  rex_load(int i, const uint8_t *prog, uint16_t len);    // returns enum rex_vm_error, or -1 for a bad index
+void rex_unload(int i);
 
-static void rex_advance_clock(int cycles) {
-	rex.cycles += cycles;
-	if (rex.cycles < rex.next_exec_cycle) {
-		return;
-	}
+void rex_set_budget(int i, int32_t budget);
+void rex_set_priority(int i, uint8_t priority);
+void rex_enable(int i, uint8_t enabled);
 
-	// execute each VM:
-	for (int i = 0; i < REX_VM_COUNT; i++) {
-		rex_vm_exec(&rex.vm[i]);
-	}
+// parks VM i until the slice for the given scanline, or until the next NMI; REX_PARK_NONE wakes it now.
+void rex_park(int i, uint8_t park, uint16_t scanline);
 
-	rex.cycles -= rex.next_exec_cycle;
-	// TODO: measure FX Pak MCU clock relative to SNES clock
-	rex.next_exec_cycle = 24;
+// called at the start of VBlank; wakes every VM parked with REX_PARK_NMI.
+void rex_signal_nmi(void);
+
+// a host thread attaches before draining responses with rex_rsp_read() and detaches when it is done. only one
+// consumer attaches at a time; rex_rsp_attach() returns -1 if another one is attached or the pool is being resized.
+int  rex_rsp_attach(struct rex_state *s);
+void rex_rsp_detach(struct rex_state *s);
+
+// drains responses queued by VM i of instance s; lock-free, and returns 0 unless the caller is attached.
+// see rex_vm_rsp_read().
+int  rex_rsp_read(struct rex_state *s, int i, uint8_t *dst, uint32_t cap);
+
+// points a chip id at host memory; chip ops copy straight to and from mem without going through the SNES bus.
+void rex_set_chip(int id, uint8_t *mem, uint32_t size, uint8_t writable);
+
+// called from the CPU event scheduler once per scanline while rex.active is non-zero.
+// the MCU is a single core, so runnable VMs share the ops it earned over master_cycles in priority order,
+// each taking at most its own budget.
+void rex_exec_slice(int32_t master_cycles, uint32_t scanline);
+
+#ifdef __cplusplus
 }
+#endif
 
 #endif
@@ -0,0 +1,758 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "rex_compile.h"
+
+#define REXC_MAX_ARGS       15
+#define REXC_MAX_BYTES      64
+#define REXC_INLINE_BYTES   0x3F
+#define REXC_MAX_PASSES     32
+// every level of nesting keeps at least one 4-byte slot on the VM stack, so a deeper call could never fit anyway;
+// the limit also keeps the recursive parser, folder and emitter off the end of the host stack.
+#define REXC_MAX_DEPTH      (REX_VM_MEMSZ / 4)
+
+enum rexc_kind {
+	REXC_UINT,
+	REXC_DPTR,
+	REXC_BYTES,
+	REXC_CALL,
+};
+
+enum {
+	REXC_FN_PURE    = 1 << 0,   // result depends only on the arguments; folded when they are constant
+	REXC_FN_LABEL0  = 1 << 1,   // argument 0 is a label number
+	REXC_FN_LABEL1  = 1 << 2,   // argument 1 is a label number
+	REXC_FN_LBL     = 1 << 3,   // (lbl n) emits nothing
+};
+
+struct rexc_fn {
+	const char *name;
+	uint8_t     op;
+	uint8_t     min_args;
+	uint8_t     max_args;
+	uint8_t     flags;
+};
+
+static const struct rexc_fn rexc_fns[] = {
+	{ "lbl",            0,                          1,  1,              REXC_FN_LBL },
+	{ "jmp",            REX_VMOP_GOTO,              1,  1,              REXC_FN_LABEL0 },
+	{ "jne",            REX_VMOP_IF,                2,  2,              REXC_FN_LABEL1 },
+	{ "jeq",            REX_VMOP_IF_NOT,            2,  2,              REXC_FN_LABEL1 },
+	{ "fn-start",       REX_VMOP_FN_START,          0,  0,              0 },
+	{ "fn-end",         REX_VMOP_RETURN,            0,  0,              0 },
+
+	{ "def-vec",        REX_VMOP_DEF_VEC,           2,  2,              0 },
+	{ "vec-assign",     REX_VMOP_VEC_ASSIGN,        1,  REXC_MAX_ARGS,  0 },
+
+	{ "chip-read-u8",   REX_VMOP_CHIP_READ_U8,      2,  2,              0 },
+	{ "chip-read-u16",  REX_VMOP_CHIP_READ_U16,     2,  2,              0 },
+	{ "chip-read-u24",  REX_VMOP_CHIP_READ_U24,     2,  2,              0 },
+	{ "chip-write-u8",  REX_VMOP_CHIP_WRITE_U8,     3,  3,              0 },
+	{ "chip-write-u16", REX_VMOP_CHIP_WRITE_U16,    3,  3,              0 },
+	{ "chip-write-u24", REX_VMOP_CHIP_WRITE_U24,    3,  3,              0 },
+	{ "chip-read",      REX_VMOP_CHIP_READ,         3,  REXC_MAX_ARGS,  0 },
+	{ "chip-write",     REX_VMOP_CHIP_WRITE,        2,  REXC_MAX_ARGS,  0 },
+
+	{ "rsp-write-vec",  REX_VMOP_RSP_WRITE_VEC,     1,  REXC_MAX_ARGS,  0 },
+
+	{ "not",            REX_VMOP_NOT,               1,  1,              REXC_FN_PURE },
+	{ "and",            REX_VMOP_AND,               2,  2,              REXC_FN_PURE },
+	{ "or",             REX_VMOP_OR,                2,  2,              REXC_FN_PURE },
+	{ "xor",            REX_VMOP_XOR,               2,  2,              REXC_FN_PURE },
+	{ "shl",            REX_VMOP_SHL,               2,  2,              REXC_FN_PURE },
+	{ "shr",            REX_VMOP_SHR,               2,  2,              REXC_FN_PURE },
+	{ "eq",             REX_VMOP_EQ,                2,  2,              REXC_FN_PURE },
+	{ "ne",             REX_VMOP_NE,                2,  2,              REXC_FN_PURE },
+	{ "add",            REX_VMOP_ADD,               2,  2,              REXC_FN_PURE },
+	{ "sub",            REX_VMOP_SUB,               2,  2,              REXC_FN_PURE },
+	{ "gt-s",           REX_VMOP_GT_SIGNED,         2,  2,              REXC_FN_PURE },
+	{ "lt-s",           REX_VMOP_LT_SIGNED,         2,  2,              REXC_FN_PURE },
+	{ "ge-s",           REX_VMOP_GE_SIGNED,         2,  2,              REXC_FN_PURE },
+	{ "le-s",           REX_VMOP_LE_SIGNED,         2,  2,              REXC_FN_PURE },
+	{ "gt-u",           REX_VMOP_GT_UNSIGNED,       2,  2,              REXC_FN_PURE },
+	{ "lt-u",           REX_VMOP_LT_UNSIGNED,       2,  2,              REXC_FN_PURE },
+	{ "ge-u",           REX_VMOP_GE_UNSIGNED,       2,  2,              REXC_FN_PURE },
+	{ "le-u",           REX_VMOP_LE_UNSIGNED,       2,  2,              REXC_FN_PURE },
+};
+
+#define REXC_FN_COUNT   (sizeof(rexc_fns) / sizeof(rexc_fns[0]))
+
+static const struct {
+	const char *name;
+	uint32_t    value;
+} rexc_consts[] = {
+	{ "WRAM",   REX_CHIP_WRAM },
+	{ "SRAM",   REX_CHIP_SRAM },
+	{ "ROM",    REX_CHIP_ROM },
+	{ "2C00",   REX_CHIP_2C00 },
+};
+
+struct rexc_node {
+	uint8_t     kind;
+	uint8_t     fn;             // index into rexc_fns[] for REXC_CALL
+	uint8_t     argc;
+	uint8_t     nbytes;
+	uint32_t    value;          // REXC_UINT, REXC_DPTR
+	int         args;           // first argument node, -1 if none
+	int         next;           // next sibling node, -1 if last
+	int         line;
+	int         col;
+	uint8_t     bytes[REXC_MAX_BYTES];
+};
+
+struct rexc_label {
+	uint32_t    num;
+	uint32_t    addr;
+};
+
+struct rexc {
+	const char                 *src;
+	size_t                      len;
+	size_t                      pos;
+	int                         line;
+	int                         col;
+	int                         depth;
+
+	struct rexc_node           *nodes;
+	int                         nnodes;
+	int                         capnodes;
+
+	struct rexc_label          *labels;
+	int                         nlabels;
+	int                         caplabels;
+
+	struct rex_compile_error   *err;
+};
+
+static int rexc_fail(struct rexc *c, int line, int col, const char *fmt, ...)
+{
+	va_list ap;
+
+	c->err->line = line;
+	c->err->col = col;
+	va_start(ap, fmt);
+	vsnprintf(c->err->msg, sizeof(c->err->msg), fmt, ap);
+	va_end(ap);
+
+	return -1;
+}
+
+static int rexc_new_node(struct rexc *c, uint8_t kind, int line, int col)
+{
+	struct rexc_node *n;
+
+	if (c->nnodes == c->capnodes) {
+		int cap = c->capnodes ? c->capnodes * 2 : 64;
+		struct rexc_node *nodes = (struct rexc_node *)realloc(c->nodes, cap * sizeof(*nodes));
+		if (!nodes)
+			return rexc_fail(c, line, col, "out of memory");
+		c->nodes = nodes;
+		c->capnodes = cap;
+	}
+
+	n = &c->nodes[c->nnodes];
+	memset(n, 0, sizeof(*n));
+	n->kind = kind;
+	n->args = -1;
+	n->next = -1;
+	n->line = line;
+	n->col = col;
+
+	return c->nnodes++;
+}
+
+static struct rexc_label *rexc_find_label(struct rexc *c, uint32_t num)
+{
+	for (int i = 0; i < c->nlabels; i++) {
+		if (c->labels[i].num == num)
+			return &c->labels[i];
+	}
+
+	return NULL;
+}
+
+static int rexc_add_label(struct rexc *c, uint32_t num, int line, int col)
+{
+	if (rexc_find_label(c, num))
+		return rexc_fail(c, line, col, "label %X defined twice", num);
+
+	if (c->nlabels == c->caplabels) {
+		int cap = c->caplabels ? c->caplabels * 2 : 16;
+		struct rexc_label *labels = (struct rexc_label *)realloc(c->labels, cap * sizeof(*labels));
+		if (!labels)
+			return rexc_fail(c, line, col, "out of memory");
+		c->labels = labels;
+		c->caplabels = cap;
+	}
+
+	c->labels[c->nlabels].num = num;
+	c->labels[c->nlabels].addr = 0;
+	c->nlabels++;
+
+	return 0;
+}
+
+// lexer
+
+static int rexc_peek(struct rexc *c)
+{
+	return c->pos < c->len ? (unsigned char)c->src[c->pos] : -1;
+}
+
+static void rexc_advance(struct rexc *c)
+{
+	if (c->src[c->pos] == '\n') {
+		c->line++;
+		c->col = 1;
+	} else {
+		c->col++;
+	}
+	c->pos++;
+}
+
+static void rexc_skip_space(struct rexc *c)
+{
+	for (;;) {
+		int ch = rexc_peek(c);
+		if (ch == ';') {
+			while (rexc_peek(c) != -1 && rexc_peek(c) != '\n')
+				rexc_advance(c);
+		} else if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') {
+			rexc_advance(c);
+		} else {
+			return;
+		}
+	}
+}
+
+static int rexc_is_delim(int ch)
+{
+	return ch == -1 || ch == '(' || ch == ')' || ch == ';' || ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+static int rexc_hex_digit(int ch)
+{
+	if (ch >= '0' && ch <= '9')
+		return ch - '0';
+	if (ch >= 'A' && ch <= 'F')
+		return ch - 'A' + 10;
+	if (ch >= 'a' && ch <= 'f')
+		return ch - 'a' + 10;
+	return -1;
+}
+
+// reads an atom into buf; returns its length
+static size_t rexc_atom(struct rexc *c, char *buf, size_t cap)
+{
+	size_t n = 0;
+
+	while (!rexc_is_delim(rexc_peek(c))) {
+		if (n + 1 < cap)
+			buf[n] = (char)rexc_peek(c);
+		n++;
+		rexc_advance(c);
+	}
+	buf[n < cap ? n : cap - 1] = 0;
+
+	return n;
+}
+
+static int rexc_parse_hex(struct rexc *c, const char *s, uint32_t max, uint32_t *value, int line, int col)
+{
+	uint64_t v = 0;
+
+	if (!*s)
+		return rexc_fail(c, line, col, "expected a hex number");
+
+	for (; *s; s++) {
+		int d = rexc_hex_digit((unsigned char)*s);
+		if (d < 0)
+			return rexc_fail(c, line, col, "bad hex digit '%c'", *s);
+		v = (v << 4) | (uint64_t)d;
+		if (v > max)
+			return rexc_fail(c, line, col, "number is larger than %X", max);
+	}
+
+	*value = (uint32_t)v;
+	return 0;
+}
+
+// parser
+
+static int rexc_parse_expr(struct rexc *c);
+
+static int rexc_parse_call(struct rexc *c)
+{
+	char    name[64];
+	int     line = c->line, col = c->col;
+	int     node, last = -1;
+	size_t  i;
+
+	if (++c->depth > REXC_MAX_DEPTH)
+		return rexc_fail(c, line, col, "calls nested deeper than %d", REXC_MAX_DEPTH);
+
+	rexc_advance(c);        // '('
+	rexc_skip_space(c);
+
+	if (rexc_peek(c) < 'a' || rexc_peek(c) > 'z')
+		return rexc_fail(c, c->line, c->col, "expected a function name");
+
+	rexc_atom(c, name, sizeof(name));
+	for (i = 0; i < REXC_FN_COUNT; i++) {
+		if (!strcmp(rexc_fns[i].name, name))
+			break;
+	}
+	if (i == REXC_FN_COUNT)
+		return rexc_fail(c, line, col, "unknown function '%s'", name);
+
+	node = rexc_new_node(c, REXC_CALL, line, col);
+	if (node < 0)
+		return -1;
+	c->nodes[node].fn = (uint8_t)i;
+
+	for (;;) {
+		int arg;
+
+		rexc_skip_space(c);
+		if (rexc_peek(c) == ')') {
+			rexc_advance(c);
+			break;
+		}
+		if (rexc_peek(c) == -1)
+			return rexc_fail(c, line, col, "unterminated call to '%s'", name);
+
+		arg = rexc_parse_expr(c);
+		if (arg < 0)
+			return -1;
+		if (c->nodes[node].argc == REXC_MAX_ARGS)
+			return rexc_fail(c, c->nodes[arg].line, c->nodes[arg].col, "too many arguments to '%s'", name);
+
+		if (last < 0)
+			c->nodes[node].args = arg;
+		else
+			c->nodes[last].next = arg;
+		last = arg;
+		c->nodes[node].argc++;
+	}
+
+	if (c->nodes[node].argc < rexc_fns[i].min_args || c->nodes[node].argc > rexc_fns[i].max_args)
+		return rexc_fail(c, line, col, "'%s' takes %d to %d arguments, got %d",
+			name, rexc_fns[i].min_args, rexc_fns[i].max_args, c->nodes[node].argc);
+
+	c->depth--;
+	return node;
+}
+
+static int rexc_parse_expr(struct rexc *c)
+{
+	char    atom[2 * REXC_MAX_BYTES * 2 + 2];
+	int     line, col, node, ch;
+	size_t  n;
+
+	rexc_skip_space(c);
+	line = c->line;
+	col = c->col;
+	ch = rexc_peek(c);
+
+	if (ch == -1)
+		return rexc_fail(c, line, col, "unexpected end of input");
+	if (ch == '(')
+		return rexc_parse_call(c);
+	if (ch == ')')
+		return rexc_fail(c, line, col, "unexpected ')'");
+
+	n = rexc_atom(c, atom, sizeof(atom));
+	if (n >= sizeof(atom))
+		return rexc_fail(c, line, col, "token too long");
+
+	if (ch == '#') {
+		size_t i;
+		for (i = 0; i < sizeof(rexc_consts) / sizeof(rexc_consts[0]); i++) {
+			if (!strcmp(rexc_consts[i].name, atom + 1))
+				break;
+		}
+		if (i == sizeof(rexc_consts) / sizeof(rexc_consts[0]))
+			return rexc_fail(c, line, col, "unknown named constant '%s'", atom);
+
+		node = rexc_new_node(c, REXC_UINT, line, col);
+		if (node >= 0)
+			c->nodes[node].value = rexc_consts[i].value;
+		return node;
+	}
+
+	if (ch == '&') {
+		uint32_t v;
+		if (rexc_parse_hex(c, atom + 1, 0xFFFF, &v, line, col) < 0)
+			return -1;
+		node = rexc_new_node(c, REXC_DPTR, line, col);
+		if (node >= 0)
+			c->nodes[node].value = v;
+		return node;
+	}
+
+	if (ch == '$') {
+		struct rexc_node *b;
+		int hi = -1;
+
+		node = rexc_new_node(c, REXC_BYTES, line, col);
+		if (node < 0)
+			return -1;
+		b = &c->nodes[node];
+		for (const char *s = atom + 1; *s; s++) {
+			int d;
+			if (*s == '_')
+				continue;
+			d = rexc_hex_digit((unsigned char)*s);
+			if (d < 0)
+				return rexc_fail(c, line, col, "bad hex digit '%c' in byte sequence", *s);
+			if (hi < 0) {
+				hi = d;
+				continue;
+			}
+			if (b->nbytes == REXC_MAX_BYTES)
+				return rexc_fail(c, line, col, "byte sequence is longer than %d bytes", REXC_MAX_BYTES);
+			b->bytes[b->nbytes++] = (uint8_t)((hi << 4) | d);
+			hi = -1;
+		}
+		if (hi >= 0)
+			return rexc_fail(c, line, col, "byte sequence has an odd number of digits");
+		if (b->nbytes == 0)
+			return rexc_fail(c, line, col, "empty byte sequence");
+		return node;
+	}
+
+	{
+		uint32_t v;
+		if (rexc_parse_hex(c, atom, 0xFFFFFFFF, &v, line, col) < 0)
+			return -1;
+		node = rexc_new_node(c, REXC_UINT, line, col);
+		if (node >= 0)
+			c->nodes[node].value = v;
+		return node;
+	}
+}
+
+// constant folding
+
+static uint32_t rexc_eval(uint8_t op, uint32_t a, uint32_t b)
+{
+	switch (op) {
+		case REX_VMOP_NOT:          return ~a;
+		case REX_VMOP_AND:          return a & b;
+		case REX_VMOP_OR:           return a | b;
+		case REX_VMOP_XOR:          return a ^ b;
+		case REX_VMOP_SHL:          return a << (b & 31);
+		case REX_VMOP_SHR:          return a >> (b & 31);
+		case REX_VMOP_EQ:           return a == b;
+		case REX_VMOP_NE:           return a != b;
+		case REX_VMOP_ADD:          return a + b;
+		case REX_VMOP_SUB:          return a - b;
+		case REX_VMOP_GT_SIGNED:    return (int32_t)a > (int32_t)b;
+		case REX_VMOP_LT_SIGNED:    return (int32_t)a < (int32_t)b;
+		case REX_VMOP_GE_SIGNED:    return (int32_t)a >= (int32_t)b;
+		case REX_VMOP_LE_SIGNED:    return (int32_t)a <= (int32_t)b;
+		case REX_VMOP_GT_UNSIGNED:  return a > b;
+		case REX_VMOP_LT_UNSIGNED:  return a < b;
+		case REX_VMOP_GE_UNSIGNED:  return a >= b;
+		case REX_VMOP_LE_UNSIGNED:  return a <= b;
+	}
+
+	return 0;
+}
+
+static void rexc_fold(struct rexc *c, int node)
+{
+	struct rexc_node *n = &c->nodes[node];
+	uint32_t args[2] = { 0, 0 };
+	int i, a;
+
+	if (n->kind != REXC_CALL)
+		return;
+
+	for (a = n->args; a >= 0; a = c->nodes[a].next)
+		rexc_fold(c, a);
+
+	if (!(rexc_fns[n->fn].flags & REXC_FN_PURE))
+		return;
+
+	for (i = 0, a = n->args; a >= 0; a = c->nodes[a].next, i++) {
+		if (c->nodes[a].kind != REXC_UINT)
+			return;
+		args[i] = c->nodes[a].value;
+	}
+
+	n->value = rexc_eval(rexc_fns[n->fn].op, args[0], args[1]);
+	n->kind = REXC_UINT;
+	n->args = -1;
+	n->argc = 0;
+}
+
+// code generation
+
+static void rexc_put(uint8_t *out, size_t cap, size_t *pos, uint8_t b)
+{
+	if (*pos < cap)
+		out[*pos] = b;
+	(*pos)++;
+}
+
+static void rexc_emit_uint(uint8_t *out, size_t cap, size_t *pos, uint32_t v)
+{
+	if (v <= 0x7F) {
+		rexc_put(out, cap, pos, (uint8_t)v);
+	} else if (v <= 0xFFF) {
+		rexc_put(out, cap, pos, (uint8_t)(0xB0 | (v >> 8)));
+		rexc_put(out, cap, pos, (uint8_t)v);
+	} else if (v <= 0xFFFF) {
+		rexc_put(out, cap, pos, 0x80);
+		rexc_put(out, cap, pos, (uint8_t)(v >> 8));
+		rexc_put(out, cap, pos, (uint8_t)v);
+	} else if (v <= 0xFFFFFF) {
+		rexc_put(out, cap, pos, 0x81);
+		rexc_put(out, cap, pos, (uint8_t)(v >> 16));
+		rexc_put(out, cap, pos, (uint8_t)(v >> 8));
+		rexc_put(out, cap, pos, (uint8_t)v);
+	} else {
+		rexc_put(out, cap, pos, 0x82);
+		rexc_put(out, cap, pos, (uint8_t)(v >> 24));
+		rexc_put(out, cap, pos, (uint8_t)(v >> 16));
+		rexc_put(out, cap, pos, (uint8_t)(v >> 8));
+		rexc_put(out, cap, pos, (uint8_t)v);
+	}
+}
+
+// number of encoded arguments once byte sequences longer than an inline array are split
+static int rexc_encoded_argc(struct rexc *c, const struct rexc_node *n)
+{
+	int argc = 0;
+
+	for (int a = n->args; a >= 0; a = c->nodes[a].next) {
+		const struct rexc_node *arg = &c->nodes[a];
+		argc += arg->kind == REXC_BYTES ? (arg->nbytes + REXC_INLINE_BYTES - 1) / REXC_INLINE_BYTES : 1;
+	}
+
+	return argc;
+}
+
+static int rexc_emit(struct rexc *c, int node, uint8_t *out, size_t cap, size_t *pos)
+{
+	const struct rexc_node *n = &c->nodes[node];
+	const struct rexc_fn *fn;
+	int argc, i, a;
+
+	switch (n->kind) {
+		case REXC_UINT:
+			rexc_emit_uint(out, cap, pos, n->value);
+			return 0;
+
+		case REXC_DPTR:
+			if (n->value <= 0xFFF) {
+				rexc_put(out, cap, pos, (uint8_t)(0x90 | (n->value >> 8)));
+				rexc_put(out, cap, pos, (uint8_t)n->value);
+			} else {
+				rexc_put(out, cap, pos, 0xA0);
+				rexc_put(out, cap, pos, (uint8_t)(n->value >> 8));
+				rexc_put(out, cap, pos, (uint8_t)n->value);
+			}
+			return 0;
+
+		case REXC_BYTES:
+			for (i = 0; i < n->nbytes; i += REXC_INLINE_BYTES) {
+				int len = n->nbytes - i < REXC_INLINE_BYTES ? n->nbytes - i : REXC_INLINE_BYTES;
+				rexc_put(out, cap, pos, (uint8_t)(0xC0 | len));
+				for (int j = 0; j < len; j++)
+					rexc_put(out, cap, pos, n->bytes[i + j]);
+			}
+			return 0;
+	}
+
+	fn = &rexc_fns[n->fn];
+	if (fn->flags & REXC_FN_LBL)
+		return rexc_fail(c, n->line, n->col, "'lbl' is only allowed as a statement");
+
+	argc = rexc_encoded_argc(c, n);
+	if (argc > REXC_MAX_ARGS)
+		return rexc_fail(c, n->line, n->col, "too many arguments to '%s' once byte sequences are split", fn->name);
+
+	if (argc < 3) {
+		rexc_put(out, cap, pos, (uint8_t)(0xA1 + argc));
+	} else {
+		rexc_put(out, cap, pos, (uint8_t)(0x80 | argc));
+	}
+	rexc_put(out, cap, pos, fn->op);
+
+	for (i = 0, a = n->args; a >= 0; a = c->nodes[a].next, i++) {
+		const struct rexc_node *arg = &c->nodes[a];
+
+		if ((i == 0 && (fn->flags & REXC_FN_LABEL0)) || (i == 1 && (fn->flags & REXC_FN_LABEL1))) {
+			const struct rexc_label *l;
+			if (arg->kind != REXC_UINT)
+				return rexc_fail(c, arg->line, arg->col, "label must be a constant");
+			l = rexc_find_label(c, arg->value);
+			if (!l)
+				return rexc_fail(c, arg->line, arg->col, "undefined label %X", arg->value);
+			rexc_emit_uint(out, cap, pos, l->addr);
+			continue;
+		}
+
+		if (rexc_emit(c, a, out, cap, pos) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+// worst-case bytes of VM stack used while evaluating node, including its own result slot
+static uint32_t rexc_stack_need(struct rexc *c, int node)
+{
+	const struct rexc_node *n = &c->nodes[node];
+	uint32_t need = 4, slot = 0;
+
+	if (n->kind != REXC_CALL)
+		return 4;
+
+	for (int a = n->args; a >= 0; a = c->nodes[a].next) {
+		const struct rexc_node *arg = &c->nodes[a];
+		int chunks = arg->kind == REXC_BYTES ? (arg->nbytes + REXC_INLINE_BYTES - 1) / REXC_INLINE_BYTES : 1;
+		uint32_t an = 4 + slot + rexc_stack_need(c, a) + 4 * (chunks - 1);
+		if (an > need)
+			need = an;
+		slot += 4 * chunks;
+	}
+
+	return need;
+}
+
+int rex_compile(const char *src, size_t srclen, uint8_t *out, size_t outcap, size_t *outlen, struct rex_compile_error *err)
+{
+	struct rexc c;
+	int    *stmts = NULL;
+	int     nstmts = 0, capstmts = 0;
+	int     ret = -1;
+	size_t  pos = 0;
+	uint32_t data = 0, stack = 0;
+
+	memset(&c, 0, sizeof(c));
+	c.src = src;
+	c.len = srclen;
+	c.line = 1;
+	c.col = 1;
+	c.err = err;
+	memset(err, 0, sizeof(*err));
+
+	// parse top-level statements:
+	for (;;) {
+		int node;
+
+		rexc_skip_space(&c);
+		if (rexc_peek(&c) == -1)
+			break;
+		if (rexc_peek(&c) != '(') {
+			rexc_fail(&c, c.line, c.col, "expected '(' to start a statement");
+			goto done;
+		}
+
+		node = rexc_parse_call(&c);
+		if (node < 0)
+			goto done;
+		rexc_fold(&c, node);
+
+		if (rexc_fns[c.nodes[node].fn].flags & REXC_FN_LBL) {
+			const struct rexc_node *arg = &c.nodes[c.nodes[node].args];
+			if (arg->kind != REXC_UINT) {
+				rexc_fail(&c, arg->line, arg->col, "label must be a constant");
+				goto done;
+			}
+			if (rexc_add_label(&c, arg->value, arg->line, arg->col) < 0)
+				goto done;
+		}
+
+		if (nstmts == capstmts) {
+			int cap = capstmts ? capstmts * 2 : 64;
+			int *s = (int *)realloc(stmts, cap * sizeof(*s));
+			if (!s) {
+				rexc_fail(&c, 0, 0, "out of memory");
+				goto done;
+			}
+			stmts = s;
+			capstmts = cap;
+		}
+		stmts[nstmts++] = node;
+	}
+
+	// emit until label addresses stop moving; jump operands only grow as labels move forward so this converges:
+	for (int pass = 0; ; pass++) {
+		int moved = 0;
+
+		if (pass == REXC_MAX_PASSES) {
+			rexc_fail(&c, 0, 0, "label addresses did not settle");
+			goto done;
+		}
+
+		pos = 0;
+		for (int i = 0; i < nstmts; i++) {
+			const struct rexc_node *n = &c.nodes[stmts[i]];
+			if (rexc_fns[n->fn].flags & REXC_FN_LBL) {
+				struct rexc_label *l = rexc_find_label(&c, c.nodes[n->args].value);
+				if (l->addr != pos) {
+					l->addr = (uint32_t)pos;
+					moved = 1;
+				}
+				continue;
+			}
+			if (rexc_emit(&c, stmts[i], out, outcap, &pos) < 0)
+				goto done;
+		}
+
+		if (!moved)
+			break;
+	}
+
+	// vectors with constant placement and the deepest statement must fit next to the program:
+	for (int i = 0; i < nstmts; i++) {
+		const struct rexc_node *n = &c.nodes[stmts[i]];
+		uint32_t need;
+
+		if (rexc_fns[n->fn].op == REX_VMOP_DEF_VEC && !(rexc_fns[n->fn].flags & REXC_FN_LBL)) {
+			const struct rexc_node *ptr = &c.nodes[n->args];
+			const struct rexc_node *cap = &c.nodes[ptr->next];
+			if ((ptr->kind == REXC_DPTR || ptr->kind == REXC_UINT) && cap->kind == REXC_UINT) {
+				uint64_t end = (uint64_t)ptr->value + 4 + cap->value;
+				if (end > REX_VM_MEMSZ) {
+					rexc_fail(&c, n->line, n->col, "vector at &%X with capacity %X does not fit in %d bytes",
+						ptr->value, cap->value, REX_VM_MEMSZ);
+					goto done;
+				}
+				if (end > data)
+					data = (uint32_t)end;
+			}
+		}
+
+		need = rexc_stack_need(&c, stmts[i]);
+		if (need > stack)
+			stack = need;
+	}
+
+	if (pos + data + stack > REX_VM_MEMSZ) {
+		rexc_fail(&c, 0, 0, "program (%u bytes) + data (%u bytes) + stack (%u bytes) exceeds REX_VM_MEMSZ (%d bytes)",
+			(unsigned)pos, data, stack, REX_VM_MEMSZ);
+		goto done;
+	}
+
+	if (pos > outcap) {
+		rexc_fail(&c, 0, 0, "program (%u bytes) does not fit in the output buffer (%u bytes)", (unsigned)pos, (unsigned)outcap);
+		goto done;
+	}
+
+	*outlen = pos;
+	ret = 0;
+
+done:
+	free(stmts);
+	free(c.nodes);
+	free(c.labels);
+
+	return ret;
+}
@@ -0,0 +1,39 @@
+#ifndef _REX_COMPILE_H_
+#define _REX_COMPILE_H_
+
+/*
+Host-side compiler from the REX LISP-like syntax described in rex_vm.h to the serialized binary format.
+
+	- constant subexpressions of pure functions (add, eq, shl, ...) are folded
+	- every uint and data pointer is emitted in its shortest form
+	- `#named-constants` are resolved at compile time
+	- `(lbl n)` names the address of the next statement; jmp/jne/jeq take label numbers
+	- `;` starts a comment that runs to the end of the line
+
+A program is rejected if its code, the vectors it defines with constant `def-vec` arguments and its worst
+case stack depth do not fit together in REX_VM_MEMSZ.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "rex_vm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rex_compile_error {
+	int  line;                  // 1-based; 0 when not tied to a source position
+	int  col;
+	char msg[128];
+};
+
+// compiles src[0..srclen) into out[0..outcap). on success returns 0 and sets *outlen.
+// on failure returns -1 and fills in *err.
+int rex_compile(const char *src, size_t srclen, uint8_t *out, size_t outcap, size_t *outlen, struct rex_compile_error *err);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
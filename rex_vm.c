@@ -2,14 +2,719 @@
 #include <string.h>
 #include <stdbool.h>
 #include "rex_vm.h"
-#include "mpack/mpack-expect.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define REX_VM_THREADED 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define REX_LOAD_ACQUIRE(x)       __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#  define REX_STORE_RELEASE(x, v)   __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+// MSVC gives volatile accesses acquire/release semantics (/volatile:ms, the default on x86 and x64)
+#  define REX_LOAD_ACQUIRE(x)       (*(volatile uint32_t *)&(x))
+#  define REX_STORE_RELEASE(x, v)   (*(volatile uint32_t *)&(x) = (v))
+#endif
+
+#define REX_VM_NOFRAME  0xFFFF
+
+// a value that refers to an inline byte array in the program: length in bits 16..21, index into m[] in bits 0..15
+#define REX_VAL_BYTES   0x80000000u
+
+// leading byte of a fused statement, followed by its index into rex_vm::fused[]; reserved in programs
+#define REX_VM_FUSED_FORM   0xA4
+
+enum rex_vm_fused_kind {
+	REX_VM_FUSED_BRANCH = 1,        // branch on a masked compare of a constant chip read
+	REX_VM_FUSED_READ_RSP,          // chip-read into a vector, then respond with it
+};
+
+REX_TLS struct rex_chip rex_chips[REX_CHIP_COUNT];
+
+static inline uint32_t rex_ld32(const uint8_t *a)
+{
+	uint32_t v;
+	memcpy(&v, a, sizeof(v));
+	return v;
+}
+
+static inline void rex_st32(uint8_t *a, uint32_t v)
+{
+	memcpy(a, &v, sizeof(v));
+}
+
+static inline uint16_t rex_ld16le(const uint8_t *a)
+{
+	return (uint16_t)(a[0] | (a[1] << 8));
+}
+
+static inline void rex_st16le(uint8_t *a, uint16_t v)
+{
+	a[0] = (uint8_t)v;
+	a[1] = (uint8_t)(v >> 8);
+}
+
+// writes the msgpack bin header for a len-byte payload and returns its size. a response is never larger
+// than m[], so bin 8 or bin 16 always fits.
+static inline uint32_t rex_st_bin_header(uint8_t *a, uint32_t len)
+{
+	if (len < 0x100) {
+		a[0] = 0xC4;
+		a[1] = (uint8_t)len;
+		return 2;
+	}
+
+	a[0] = 0xC5;
+	a[1] = (uint8_t)(len >> 8);
+	a[2] = (uint8_t)len;
+	return 3;
+}
+
+// copies len bytes starting at chip offset offs into dst. the offset wraps at 24 bits and bytes at or
+// past size read as 0, so a transfer splits into at most a few memcpy/memset runs rather than per-byte lookups.
+static void rex_chip_read(const struct rex_chip *c, uint32_t offs, uint8_t *dst, uint32_t len)
+{
+	while (len) {
+		uint32_t run;
+
+		offs &= 0xFFFFFF;
+		run = 0x1000000 - offs;
+		if (run > len)
+			run = len;
+
+		if (offs < c->size) {
+			if (run > c->size - offs)
+				run = c->size - offs;
+			memcpy(dst, c->mem + offs, run);
+		} else {
+			memset(dst, 0, run);
+		}
+
+		dst += run;
+		offs += run;
+		len -= run;
+	}
+}
+
+// copies len bytes from src to chip offset offs; same wrapping as rex_chip_read, bytes past size are dropped.
+static void rex_chip_write(const struct rex_chip *c, uint32_t offs, const uint8_t *src, uint32_t len)
+{
+	if (!c->writable)
+		return;
+
+	while (len) {
+		uint32_t run;
+
+		offs &= 0xFFFFFF;
+		run = 0x1000000 - offs;
+		if (run > len)
+			run = len;
+
+		if (offs < c->size) {
+			if (run > c->size - offs)
+				run = c->size - offs;
+			memcpy(c->mem + offs, src, run);
+		}
+
+		src += run;
+		offs += run;
+		len -= run;
+	}
+}
+
+static inline uint32_t rex_chip_read_le(const struct rex_chip *c, uint32_t offs, uint32_t width)
+{
+	uint8_t b[3];
+
+	offs &= 0xFFFFFF;
+	if (offs + width <= c->size) {
+		const uint8_t *a = c->mem + offs;
+		return width == 1 ? a[0] : width == 2 ? (uint32_t)(a[0] | (a[1] << 8)) : (uint32_t)(a[0] | (a[1] << 8) | (a[2] << 16));
+	}
+
+	rex_chip_read(c, offs, b, width);
+	return width == 1 ? b[0] : width == 2 ? (uint32_t)(b[0] | (b[1] << 8)) : (uint32_t)(b[0] | (b[1] << 8) | (b[2] << 16));
+}
+
+static inline void rex_chip_write_le(const struct rex_chip *c, uint32_t offs, uint32_t width, uint32_t data)
+{
+	uint8_t b[3] = { (uint8_t)data, (uint8_t)(data >> 8), (uint8_t)(data >> 16) };
+
+	rex_chip_write(c, offs, b, width);
+}
+
+static void rex_ring_put(struct rex_rsp_ring *r, uint32_t pos, const uint8_t *src, uint32_t len)
+{
+	uint32_t i = pos & (REX_RSP_RINGSZ - 1);
+	uint32_t run = REX_RSP_RINGSZ - i;
+
+	if (run > len)
+		run = len;
+	memcpy(r->buf + i, src, run);
+	memcpy(r->buf, src + run, len - run);
+}
+
+static void rex_ring_get(const struct rex_rsp_ring *r, uint32_t pos, uint8_t *dst, uint32_t len)
+{
+	uint32_t i = pos & (REX_RSP_RINGSZ - 1);
+	uint32_t run = REX_RSP_RINGSZ - i;
+
+	if (run > len)
+		run = len;
+	memcpy(dst, r->buf + i, run);
+	memcpy(dst + run, r->buf, len - run);
+}
+
+// producer side: queues msg as one record, or counts it as dropped when the consumer has fallen behind.
+static int rex_rsp_push(struct rex_rsp_ring *r, const uint8_t *msg, uint32_t len)
+{
+	uint32_t head = r->head;
+	uint32_t tail = REX_LOAD_ACQUIRE(r->tail);
+	uint8_t  hdr[2];
+
+	if (REX_RSP_RINGSZ - (head - tail) < len + 2) {
+		r->dropped++;
+		return 0;
+	}
+
+	rex_st16le(hdr, (uint16_t)len);
+	rex_ring_put(r, head, hdr, 2);
+	rex_ring_put(r, head + 2, msg, len);
+	REX_STORE_RELEASE(r->head, head + 2 + len);
+
+	return 1;
+}
+
+// queues src[0..len) as one msgpack bin response
+static int rex_rsp_send(struct rex_vm *vm, const uint8_t *src, uint32_t len)
+{
+	uint8_t msg[REX_VM_MEMSZ + 8];
+	uint32_t n = rex_st_bin_header(msg, len);
+
+	memcpy(msg + n, src, len);
+	return rex_rsp_push(&vm->rsp, msg, n + len);
+}
+
+int rex_vm_rsp_read(struct rex_vm *vm, uint8_t *dst, uint32_t cap)
+{
+	struct rex_rsp_ring *r = &vm->rsp;
+	uint32_t tail = r->tail;
+	uint32_t head = REX_LOAD_ACQUIRE(r->head);
+	uint8_t  hdr[2];
+	uint32_t len;
+
+	if (head == tail)
+		return 0;
+
+	rex_ring_get(r, tail, hdr, 2);
+	len = rex_ld16le(hdr);
+	if (len > cap)
+		return -1;
+
+	rex_ring_get(r, tail + 2, dst, len);
+	REX_STORE_RELEASE(r->tail, tail + 2 + len);
+
+	return (int)len;
+}
 
 void rex_vm_init(struct rex_vm *vm)
 {
 	memset(vm->m, 0, sizeof(vm->m));
+	vm->p = 0;
+	vm->s = REX_VM_MEMSZ;
+	vm->f = REX_VM_NOFRAME;
+	vm->e = 0;
+	vm->d = 0;
+	vm->status = REX_VM_READY;
+	vm->err = REX_VM_ERR_NONE;
+	vm->verified = 0;
+	vm->nfused = 0;
+	vm->ops = 0;
+	vm->skipped = 0;
 }
 
-void rex_vm_exec(struct rex_vm *vm)
+static const struct {
+	uint8_t known;
+	uint8_t min_args;
+	uint8_t max_args;
+} rex_vm_arity[256] = {
+	[REX_VMOP_RETURN]           = { 1, 0,  0 },
+	[REX_VMOP_GOTO]             = { 1, 1,  1 },
+	[REX_VMOP_IF]               = { 1, 2,  2 },
+	[REX_VMOP_IF_NOT]           = { 1, 2,  2 },
+	[REX_VMOP_FN_START]         = { 1, 0,  0 },
+	[REX_VMOP_DEF_VEC]          = { 1, 2,  2 },
+	[REX_VMOP_VEC_ASSIGN]       = { 1, 1, 15 },
+	[REX_VMOP_CHIP_READ_U8]     = { 1, 2,  2 },
+	[REX_VMOP_CHIP_READ_U16]    = { 1, 2,  2 },
+	[REX_VMOP_CHIP_READ_U24]    = { 1, 2,  2 },
+	[REX_VMOP_CHIP_WRITE_U8]    = { 1, 3,  3 },
+	[REX_VMOP_CHIP_WRITE_U16]   = { 1, 3,  3 },
+	[REX_VMOP_CHIP_WRITE_U24]   = { 1, 3,  3 },
+	[REX_VMOP_CHIP_READ]        = { 1, 3, 15 },
+	[REX_VMOP_CHIP_WRITE]       = { 1, 2, 15 },
+	[REX_VMOP_RSP_WRITE_VEC]    = { 1, 1, 15 },
+	[REX_VMOP_NOT]              = { 1, 1,  1 },
+	[REX_VMOP_AND]              = { 1, 2,  2 },
+	[REX_VMOP_OR]               = { 1, 2,  2 },
+	[REX_VMOP_XOR]              = { 1, 2,  2 },
+	[REX_VMOP_SHL]              = { 1, 2,  2 },
+	[REX_VMOP_SHR]              = { 1, 2,  2 },
+	[REX_VMOP_EQ]               = { 1, 2,  2 },
+	[REX_VMOP_NE]               = { 1, 2,  2 },
+	[REX_VMOP_ADD]              = { 1, 2,  2 },
+	[REX_VMOP_SUB]              = { 1, 2,  2 },
+	[REX_VMOP_GT_SIGNED]        = { 1, 2,  2 },
+	[REX_VMOP_LT_SIGNED]        = { 1, 2,  2 },
+	[REX_VMOP_GE_SIGNED]        = { 1, 2,  2 },
+	[REX_VMOP_LE_SIGNED]        = { 1, 2,  2 },
+	[REX_VMOP_GT_UNSIGNED]      = { 1, 2,  2 },
+	[REX_VMOP_LT_UNSIGNED]      = { 1, 2,  2 },
+	[REX_VMOP_GE_UNSIGNED]      = { 1, 2,  2 },
+	[REX_VMOP_LE_UNSIGNED]      = { 1, 2,  2 },
+};
+
+// what the verifier can prove about the value of an expression
+enum rex_vm_vkind {
+	REX_VK_DYNAMIC = 0,
+	REX_VK_UINT,
+	REX_VK_PTR,
+	REX_VK_BYTES,
+};
+
+// how an opcode uses one of its arguments
+enum rex_vm_vuse {
+	REX_VU_VALUE = 0,
+	REX_VU_DEF_VEC,             // defines the vector at this pointer
+	REX_VU_VEC,                 // a defined vector
+	REX_VU_VEC_OR_BYTES,        // a defined vector or an inline byte array
+	REX_VU_TARGET,              // a jump target
+};
+
+struct rex_vm_verifier {
+	const uint8_t *m;
+	uint32_t  d;
+	uint32_t  pass;             // 0 collects statements and vectors, 1 checks their uses
+	uint32_t  stack;            // deepest stack use of any statement
+	uint32_t  data;             // end of the furthest vector relative to d
+	uint32_t  nvec;
+	uint16_t  vec_ptr[REX_VM_MEMSZ / 4];
+	uint16_t  vec_cap[REX_VM_MEMSZ / 4];
+	uint8_t   stmt[REX_VM_MEMSZ];
+};
+
+static inline int rex_vm_is_call(uint8_t b)
 {
-	
+	return (b >= 0x83 && b <= 0x8F) || (b >= 0xA1 && b <= 0xA3);
 }
+
+// decodes the constant or inline byte array at p; returns the index just past it, or 0 if it is not one.
+static uint32_t rex_vm_decode_leaf(const uint8_t *m, uint32_t d, uint32_t p, uint8_t *kind, uint32_t *value)
+{
+	uint8_t b;
+
+	*kind = REX_VK_DYNAMIC;
+	*value = 0;
+
+	if (p >= d)
+		return 0;
+
+	b = m[p];
+	if (b < 0x80) {
+		*kind = REX_VK_UINT;
+		*value = b;
+		return p + 1;
+	}
+	if (b >= 0xC0) {
+		if (p + 1 + (b & 0x3F) > d)
+			return 0;
+		*kind = REX_VK_BYTES;
+		return p + 1 + (b & 0x3F);
+	}
+	if ((b & 0xF0) == 0xB0 || (b & 0xF0) == 0x90) {
+		if (p + 2 > d)
+			return 0;
+		*kind = (b & 0xF0) == 0xB0 ? REX_VK_UINT : REX_VK_PTR;
+		*value = ((uint32_t)(b & 0x0F) << 8) | m[p+1];
+		return p + 2;
+	}
+	if (b == 0x80 || b == 0xA0) {
+		if (p + 3 > d)
+			return 0;
+		*kind = b == 0x80 ? REX_VK_UINT : REX_VK_PTR;
+		*value = ((uint32_t)m[p+1] << 8) | m[p+2];
+		return p + 3;
+	}
+	if (b == 0x81 || b == 0x82) {
+		uint32_t k = b == 0x81 ? 3 : 4;
+		if (p + 1 + k > d)
+			return 0;
+		*kind = REX_VK_UINT;
+		for (uint32_t i = 0; i < k; i++)
+			*value = (*value << 8) | m[p+1+i];
+		return p + 1 + k;
+	}
+
+	return 0;
+}
+
+static uint8_t rex_vm_arg_use(uint8_t op, uint32_t i)
+{
+	switch (op) {
+		case REX_VMOP_GOTO:         return REX_VU_TARGET;
+		case REX_VMOP_IF:
+		case REX_VMOP_IF_NOT:       return i == 1 ? REX_VU_TARGET : REX_VU_VALUE;
+		case REX_VMOP_DEF_VEC:      return i == 0 ? REX_VU_DEF_VEC : REX_VU_VALUE;
+		case REX_VMOP_VEC_ASSIGN:   return i == 0 ? REX_VU_VEC : REX_VU_VALUE;
+		case REX_VMOP_CHIP_READ:    return i >= 3 ? REX_VU_VEC : REX_VU_VALUE;
+		case REX_VMOP_CHIP_WRITE:   return i >= 2 ? REX_VU_VEC_OR_BYTES : REX_VU_VALUE;
+		case REX_VMOP_RSP_WRITE_VEC:return REX_VU_VEC_OR_BYTES;
+	}
+
+	return REX_VU_VALUE;
+}
+
+static int rex_vm_verify_vec(const struct rex_vm_verifier *V, uint8_t kind, uint32_t value)
+{
+	if (kind != REX_VK_PTR && kind != REX_VK_UINT)
+		return 0;
+
+	// a u32 with the top bit set would be taken for an inline byte array:
+	if (value > 0xFFFF)
+		return 0;
+
+	if (V->pass == 0)
+		return 1;
+
+	for (uint32_t i = 0; i < V->nvec; i++) {
+		if (V->vec_ptr[i] == value)
+			return 1;
+	}
+
+	return 0;
+}
+
+static int rex_vm_add_vec(struct rex_vm_verifier *V, uint32_t ptr, uint32_t cap)
+{
+	uint32_t i;
+
+	if (ptr > 0xFFFF || cap > REX_VM_MEMSZ || V->d + ptr + 4 + cap > REX_VM_MEMSZ)
+		return 0;
+
+	for (i = 0; i < V->nvec; i++) {
+		if (V->vec_ptr[i] == ptr) {
+			if (cap > V->vec_cap[i])
+				V->vec_cap[i] = (uint16_t)cap;
+			break;
+		}
+	}
+	if (i == V->nvec) {
+		if (V->nvec == REX_VM_MEMSZ / 4)
+			return 0;
+		V->vec_ptr[V->nvec] = (uint16_t)ptr;
+		V->vec_cap[V->nvec] = (uint16_t)cap;
+		V->nvec++;
+	}
+
+	if (ptr + 4 + cap > V->data)
+		V->data = ptr + 4 + cap;
+
+	return 1;
+}
+
+// checks the expression at p and returns the index just past it, or 0 if it cannot be proven safe.
+// *need is the stack it uses including its own result slot.
+static uint32_t rex_vm_verify_expr(struct rex_vm_verifier *V, uint32_t p, uint32_t depth, uint8_t *kind, uint32_t *value, uint32_t *need)
+{
+	const uint8_t *m = V->m;
+	uint32_t argc, worst, defvec[2] = { 0, 0 };
+	uint8_t  b, op;
+
+	*kind = REX_VK_DYNAMIC;
+	*value = 0;
+	*need = 4;
+
+	if (p >= V->d || depth > REX_VM_MEMSZ / 4)
+		return 0;
+
+	b = m[p];
+	if (!rex_vm_is_call(b))
+		return rex_vm_decode_leaf(m, V->d, p, kind, value);
+
+	// a call:
+	argc = b >= 0xA1 ? (uint32_t)(b - 0xA1) : (uint32_t)(b & 0x0F);
+	if (p + 2 > V->d)
+		return 0;
+	op = m[p+1];
+	if (!rex_vm_arity[op].known || argc < rex_vm_arity[op].min_args || argc > rex_vm_arity[op].max_args)
+		return 0;
+
+	// (fn-end) resumes at the point (fn-start) recorded, which must be a statement start:
+	if (op == REX_VMOP_FN_START && depth != 0)
+		return 0;
+
+	p += 2;
+	worst = 4;
+	for (uint32_t i = 0; i < argc; i++) {
+		uint8_t  ak;
+		uint32_t av, an;
+
+		p = rex_vm_verify_expr(V, p, depth + 1, &ak, &av, &an);
+		if (!p)
+			return 0;
+		if (4 + 4 * i + an > worst)
+			worst = 4 + 4 * i + an;
+
+		switch (rex_vm_arg_use(op, i)) {
+			case REX_VU_DEF_VEC:
+				if (ak != REX_VK_PTR && ak != REX_VK_UINT)
+					return 0;
+				defvec[0] = av;
+				break;
+			case REX_VU_VEC:
+				if (!rex_vm_verify_vec(V, ak, av))
+					return 0;
+				break;
+			case REX_VU_VEC_OR_BYTES:
+				if (ak != REX_VK_BYTES && !rex_vm_verify_vec(V, ak, av))
+					return 0;
+				break;
+			case REX_VU_TARGET:
+				if (ak != REX_VK_UINT || av >= V->d || (V->pass == 1 && !V->stmt[av]))
+					return 0;
+				break;
+			default:
+				if (op == REX_VMOP_DEF_VEC) {
+					if (ak != REX_VK_UINT)
+						return 0;
+					defvec[1] = av;
+				}
+				break;
+		}
+	}
+
+	if (op == REX_VMOP_DEF_VEC && V->pass == 0 && !rex_vm_add_vec(V, defvec[0], defvec[1]))
+		return 0;
+
+	*need = worst;
+	return p;
+}
+
+// proves that the program cannot fault on form, argument count, program bounds, stack overflow, data
+// bounds or jump targets, which lets rex_vm_exec() drop those checks from its inner loop.
+static int rex_vm_verify(struct rex_vm_verifier *V, const uint8_t *m, uint16_t d)
+{
+	uint32_t i, j;
+
+	memset(V, 0, sizeof(*V));
+	V->m = m;
+	V->d = d;
+
+	for (V->pass = 0; V->pass < 2; V->pass++) {
+		for (uint32_t p = 0; p < d; ) {
+			uint8_t  kind;
+			uint32_t value, need;
+
+			V->stmt[p] = 1;
+			p = rex_vm_verify_expr(V, p, 0, &kind, &value, &need);
+			if (!p)
+				return 0;
+			if (need > V->stack)
+				V->stack = need;
+		}
+	}
+
+	// vectors must not overlap, or writing one could change another's capacity:
+	for (i = 0; i < V->nvec; i++) {
+		for (j = i + 1; j < V->nvec; j++) {
+			uint32_t a0 = V->vec_ptr[i], a1 = a0 + 4 + V->vec_cap[i];
+			uint32_t b0 = V->vec_ptr[j], b1 = b0 + 4 + V->vec_cap[j];
+			if (a0 < b1 && b0 < a1)
+				return 0;
+		}
+	}
+
+	// and the deepest statement must not reach them:
+	return (uint32_t)d + V->data + V->stack <= REX_VM_MEMSZ;
+}
+
+// decodes a call header at p; returns the index of its first argument, or 0 if p is not a call.
+static uint32_t rex_vm_decode_call(const uint8_t *m, uint32_t d, uint32_t p, uint8_t *op, uint8_t *argc)
+{
+	if (p + 2 > d || !rex_vm_is_call(m[p]))
+		return 0;
+
+	*argc = m[p] >= 0xA1 ? (uint8_t)(m[p] - 0xA1) : (uint8_t)(m[p] & 0x0F);
+	*op = m[p+1];
+
+	return p + 2;
+}
+
+// decodes a constant; returns the index just past it, or 0 if p is anything else.
+static uint32_t rex_vm_decode_const(const uint8_t *m, uint32_t d, uint32_t p, uint32_t *value)
+{
+	uint8_t kind;
+
+	p = rex_vm_decode_leaf(m, d, p, &kind, value);
+
+	return kind == REX_VK_UINT || kind == REX_VK_PTR ? p : 0;
+}
+
+// matches (chip-read-u8|u16|u24 chip offs) with constant chip and offs
+static uint32_t rex_vm_match_read(const uint8_t *m, uint32_t d, uint32_t p, struct rex_vm_fused *x)
+{
+	uint8_t  op, argc;
+	uint32_t chip;
+
+	p = rex_vm_decode_call(m, d, p, &op, &argc);
+	if (!p || argc != 2 || op < REX_VMOP_CHIP_READ_U8 || op > REX_VMOP_CHIP_READ_U24)
+		return 0;
+
+	if (!(p = rex_vm_decode_const(m, d, p, &chip)) || chip >= REX_CHIP_COUNT)
+		return 0;
+	if (!(p = rex_vm_decode_const(m, d, p, &x->offs)))
+		return 0;
+
+	x->chip = (uint8_t)chip;
+	x->width = (uint8_t)(op - REX_VMOP_CHIP_READ_U8 + 1);
+
+	return p;
+}
+
+// (jne|jeq R target) or (jne|jeq (eq|ne|and R k) target) where R is a constant chip read:
+static int rex_vm_match_branch(const uint8_t *m, uint32_t d, uint32_t p, uint32_t end, struct rex_vm_fused *x)
+{
+	uint8_t  op, argc, cmp = 0;
+	uint32_t q, k = 0, target;
+	int      taken_if_zero;
+
+	q = rex_vm_decode_call(m, d, p, &op, &argc);
+	if (!q || argc != 2 || (op != REX_VMOP_IF && op != REX_VMOP_IF_NOT))
+		return 0;
+	taken_if_zero = op == REX_VMOP_IF_NOT;
+	x->ops = 2;
+
+	if (!(p = rex_vm_match_read(m, d, q, x))) {
+		if (!(p = rex_vm_decode_call(m, d, q, &cmp, &argc)) || argc != 2)
+			return 0;
+		if (cmp != REX_VMOP_EQ && cmp != REX_VMOP_NE && cmp != REX_VMOP_AND)
+			return 0;
+		if (!(p = rex_vm_match_read(m, d, p, x)) || !(p = rex_vm_decode_const(m, d, p, &k)))
+			return 0;
+		x->ops = 3;
+	}
+
+	if (!(p = rex_vm_decode_const(m, d, p, &target)) || p != end)
+		return 0;
+
+	// every form reduces to: taken when ((R & mask) == value) == equal
+	x->kind = REX_VM_FUSED_BRANCH;
+	x->target = (uint16_t)target;
+	x->next = (uint16_t)end;
+	switch (cmp) {
+		case REX_VMOP_EQ:   x->mask = 0xFFFFFFFF; x->value = k; x->equal = (uint8_t)!taken_if_zero; break;
+		case REX_VMOP_NE:   x->mask = 0xFFFFFFFF; x->value = k; x->equal = (uint8_t)taken_if_zero;  break;
+		case REX_VMOP_AND:  x->mask = k;          x->value = 0; x->equal = (uint8_t)taken_if_zero;  break;
+		default:            x->mask = 0xFFFFFFFF; x->value = 0; x->equal = (uint8_t)taken_if_zero;  break;
+	}
+
+	return 1;
+}
+
+// (chip-read chip offs len &v) immediately followed by (rsp-write-vec &v), all constant:
+static int rex_vm_match_read_rsp(const uint8_t *m, uint32_t d, uint32_t p, uint32_t end, uint32_t end2, struct rex_vm_fused *x)
+{
+	uint8_t  op, argc;
+	uint32_t chip, len, vec, vec2;
+
+	if (!(p = rex_vm_decode_call(m, d, p, &op, &argc)) || op != REX_VMOP_CHIP_READ || argc != 4)
+		return 0;
+	if (!(p = rex_vm_decode_const(m, d, p, &chip)) || chip >= REX_CHIP_COUNT)
+		return 0;
+	if (!(p = rex_vm_decode_const(m, d, p, &x->offs)) || !(p = rex_vm_decode_const(m, d, p, &len)))
+		return 0;
+	if (!(p = rex_vm_decode_const(m, d, p, &vec)) || p != end)
+		return 0;
+
+	if (!(p = rex_vm_decode_call(m, d, p, &op, &argc)) || op != REX_VMOP_RSP_WRITE_VEC || argc != 1)
+		return 0;
+	if (!(p = rex_vm_decode_const(m, d, p, &vec2)) || vec2 != vec || p != end2)
+		return 0;
+
+	x->kind = REX_VM_FUSED_READ_RSP;
+	x->chip = (uint8_t)chip;
+	x->value = len;
+	x->target = (uint16_t)vec;
+	x->mid = (uint16_t)end;
+	x->next = (uint16_t)end2;
+	x->ops = 2;
+
+	return 1;
+}
+
+// rewrites common statements of a verified program into fused forms that execute in one dispatch. only the
+// first two bytes of a statement change, so jump targets and later statements are untouched.
+static void rex_vm_fuse(struct rex_vm *vm, const struct rex_vm_verifier *V)
+{
+	uint8_t *m = vm->m;
+	uint32_t d = vm->d;
+	uint32_t p = 0;
+
+	vm->nfused = 0;
+
+	while (p < d && vm->nfused < REX_VM_FUSED_MAX) {
+		struct rex_vm_fused *x = &vm->fused[vm->nfused];
+		uint32_t end = p + 1, end2;
+
+		while (end < d && !V->stmt[end])
+			end++;
+		end2 = end + 1;
+		while (end2 < d && !V->stmt[end2])
+			end2++;
+
+		memset(x, 0, sizeof(*x));
+		if (rex_vm_match_branch(m, d, p, end, x) || (end < d && rex_vm_match_read_rsp(m, d, p, end, end2, x))) {
+			m[p+0] = REX_VM_FUSED_FORM;
+			m[p+1] = vm->nfused++;
+		}
+
+		p = end;
+	}
+}
+
+int rex_vm_load(struct rex_vm *vm, const uint8_t *prog, uint16_t len)
+{
+	struct rex_vm_verifier V;
+
+	rex_vm_init(vm);
+
+	// leave at least one stack slot:
+	if (len > REX_VM_MEMSZ - 4) {
+		vm->status = REX_VM_FAULT;
+		vm->err = REX_VM_ERR_TOO_BIG;
+		return vm->err;
+	}
+
+	memcpy(vm->m, prog, len);
+	vm->d = len;
+	vm->verified = (uint8_t)rex_vm_verify(&V, vm->m, len);
+	if (vm->verified)
+		rex_vm_fuse(vm, &V);
+
+	return REX_VM_ERR_NONE;
+}
+
+#define REX_VM_CHECKED 1
+#define REX_VM_EXEC rex_vm_exec_checked
+#include "rex_vm_exec.h"
+
+#define REX_VM_CHECKED 0
+#define REX_VM_EXEC rex_vm_exec_verified
+#include "rex_vm_exec.h"
+
+int rex_vm_exec(struct rex_vm *vm, int32_t budget)
+{
+	vm->skipped = 0;
+	return vm->verified ? rex_vm_exec_verified(vm, budget) : rex_vm_exec_checked(vm, budget);
+}
+
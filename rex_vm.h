@@ -34,12 +34,12 @@ types:
 example program:
 ```
 	(def-vec  &0 10)
-	(def-vec &10 10)
+	(def-vec &20 10)
 	(vec-assign &0 $9C002C_6CEAFF)
 	(fn-start)
 		(lbl 0)
 		(jne (chip-read-u8 #2C00 0) 0)
-		(chip-write-vec #2C00 0 &0)
+		(chip-write #2C00 0 &0)
 		(rsp-write-vec &0)
 		(jmp 0)
 	(fn-end)
@@ -47,7 +47,8 @@ example program:
 
 serialized binary format of an expression: (x and y are big-endian with MSB to LSB left-to-right across bytes)
 	11xxxxxx [x bytes]                           = inline byte array of x bytes long (0..$3F)
-	1000xxxx_yyyyyyyy [x exprs]                  = opcode y (0..$FF) with x argument expressions (0..$F)
+	1000xxxx_yyyyyyyy [x exprs]                  = opcode y (0..$FF) with x argument expressions (3..$F)
+	101000xx_yyyyyyyy [x-1 exprs]                = opcode y (0..$FF) with x-1 argument expressions (0..2)
 	1001xxxx_xxxxxxxx                            = data pointer (0..$FFF)
 	10100000_xxxxxxxx_xxxxxxxx                   = data pointer (0..$FFFF)
 	0xxxxxxx                                     = uint up to $7F (u8)
@@ -56,6 +57,10 @@ serialized binary format of an expression: (x and y are big-endian with MSB to L
 	10000001_xxxxxxxx_xxxxxxxx_xxxxxxxx          = uint up to $FFFFFF (u24)
 	10000010_xxxxxxxx_xxxxxxxx_xxxxxxxx_xxxxxxxx = uint up to $FFFFFFFF (u32)
 
+	$80..$82 are taken by the uint forms so calls with fewer than 3 arguments use $A1..$A3 instead.
+	$A4..$AF are reserved. the loader rewrites common statements of verified programs to start with $A4
+	(see rex_vm::fused), so m[0..d) may differ from the loaded program.
+
 functions are statically typed:
 	(def-vec    addr:ptr cap:u16)
 	(vec-assign addr:ptr bytes:u8...)
@@ -69,20 +74,59 @@ functions are statically typed:
 	(chip-read      chip:u8 offs:u32 len:u16 dest:ptr...):void
 	(chip-write     chip:u8 offs:u32 src:ptr...):void
 
+	(rsp-write-vec  src:ptr...):u8   ; queues one response; 1 if queued, 0 if the ring was full
+
+	(not x:u32):u32
+	(and|or|xor|shl|shr|add|sub x:u32 y:u32):u32
+	(eq|ne|gt-s|lt-s|ge-s|le-s|gt-u|lt-u|ge-u|le-u x:u32 y:u32):u32   ; 1 or 0
+
+control flow:
+	(lbl n)          ; compile-time only; names the address of the next statement
+	(jmp lbl)        ; continue at lbl
+	(jne x lbl)      ; continue at lbl if x is non-zero
+	(jeq x lbl)      ; continue at lbl if x is zero
+	(fn-start)       ; marks the entry point that (fn-end) returns to
+	(fn-end)         ; ends the current exec slice; the next slice resumes at (fn-start)
+
+	statements before (fn-start) run once after loading; the body between (fn-start) and (fn-end)
+	runs once per exec slice unless the instruction budget runs out first, in which case it
+	resumes exactly where it stopped. jump targets are absolute offsets into the program.
+
  named-constants:
 	 `#WRAM`
 	 `#SRAM`
+	 `#ROM`
 	 `#2C00`
 
  memory layout:
-	 program
-	 stack
-	 data
+	 program                ; m[0] .. m[d-1]
+	 data                   ; m[d] ..        data-pointer &x addresses m[d + x]
+	 stack                  ;      .. m[len(m)-1], grows down, 4 bytes per slot
+
+ vector layout at a data pointer:
+	 cap:u16 len:u16 bytes[cap]   ; little-endian
+
+ responses:
+	 each (rsp-write-vec ...) concatenates its sources into a single msgpack bin object and queues it on
+	 the VM's response ring. the ring is single-producer/single-consumer: rex_vm_exec() on the emulation
+	 thread produces, and one host thread drains with rex_vm_rsp_read() without any lock. a response that
+	 does not fit is dropped and counted rather than blocking emulation.
 
 */
 
 #include <stdint.h>
 
+// one REX per emulator instance; see S9X_TLS in port.h
+#ifndef REX_TLS
+#  if !defined(S9X_MULTI_INSTANCE)
+#    define REX_TLS
+#  elif defined(__cplusplus)
+#    define REX_TLS thread_local
+#  else
+#    define REX_TLS _Thread_local
+#  endif
+#endif
+
 #ifndef REX_VM_MEMSZ
 #  define REX_VM_MEMSZ 1024
 #endif
@@ -91,23 +135,147 @@ functions are statically typed:
 #  error REX_VM_MEMSZ cannot be more than 4096 bytes
 #endif
 
+#ifndef REX_RSP_RINGSZ
+#  define REX_RSP_RINGSZ 8192
+#endif
+
+#if REX_RSP_RINGSZ & (REX_RSP_RINGSZ - 1)
+#  error REX_RSP_RINGSZ must be a power of two
+#endif
+
+#ifndef REX_VM_FUSED_MAX
+#  define REX_VM_FUSED_MAX 32
+#endif
+
+#if REX_VM_FUSED_MAX > 256
+#  error REX_VM_FUSED_MAX cannot be more than 256
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum rex_vm_status {
+	REX_VM_READY = 0,           // nothing loaded or never run
+	REX_VM_YIELD,               // budget exhausted or (fn-end) reached; call exec again to resume
+	REX_VM_HALTED,              // ran off the end of the program
+	REX_VM_FAULT,               // see rex_vm::err
+};
+
+enum rex_vm_error {
+	REX_VM_ERR_NONE = 0,
+	REX_VM_ERR_TOO_BIG,         // program does not fit in m[]
+	REX_VM_ERR_BAD_FORM,        // reserved leading byte
+	REX_VM_ERR_BAD_OPCODE,
+	REX_VM_ERR_BAD_ARGC,
+	REX_VM_ERR_PROGRAM_BOUNDS,  // expression or jump target past the end of the program
+	REX_VM_ERR_DATA_BOUNDS,     // data pointer or vector past the end of m[]
+	REX_VM_ERR_STACK_OVERFLOW,
+	REX_VM_ERR_BAD_CHIP,
+};
+
+// each record is a u16le length followed by that many bytes of msgpack. head and tail are free-running
+// and only ever written by the producer and the consumer respectively; they sit on separate cache lines
+// so a polling consumer does not keep stealing the emulation thread's line.
+struct rex_rsp_ring {
+	uint32_t   head;            // producer: bytes ever queued
+	uint32_t   dropped;         // producer: responses that did not fit
+	uint8_t    pad0[56];
+	uint32_t   tail;            // consumer: bytes ever drained
+	uint8_t    pad1[60];
+	uint8_t    buf[REX_RSP_RINGSZ];
+};
+
+// operands of a statement the loader fused into a single dispatch; internal to rex_vm.c
+struct rex_vm_fused {
+	uint32_t   offs;            // chip offset
+	uint32_t   mask;
+	uint32_t   value;           // compare value, or read length
+	uint16_t   target;          // jump target, or vector pointer
+	uint16_t   mid;             // second of two fused statements
+	uint16_t   next;            // statement after the fused ones
+	uint8_t    kind;
+	uint8_t    chip;
+	uint8_t    width;
+	uint8_t    equal;           // branch taken when ((read & mask) == value) == equal
+	uint8_t    ops;             // ops the unfused statements would have counted
+};
+
 struct rex_vm {
 	uint16_t   p;               // program counter as index into m[], starts at 0
-	uint16_t   s;               // stack pointer as index into m[], starts at len(m)-1
+	uint16_t   s;               // stack pointer as index into m[], starts at len(m)
+	uint16_t   f;               // index into m[] of the innermost pending call frame
+	uint16_t   e;               // entry point set by (fn-start)
+	uint16_t   d;               // data segment base; also the program length
+	uint8_t    status;          // enum rex_vm_status
+	uint8_t    err;             // enum rex_vm_error
+	uint8_t    verified;        // passed the load-time verifier; runs without per-op range checks
+	uint32_t   ops;             // ops executed by the last rex_vm_exec()
+	uint32_t   skipped;         // of those, budget a poll branching to itself spent without going round
 
 	uint8_t m[REX_VM_MEMSZ];    // read-write memory
+
+	uint8_t    nfused;
+	struct rex_vm_fused fused[REX_VM_FUSED_MAX];
+
+	struct rex_rsp_ring rsp;    // left alone by rex_vm_init() so a reload never races the consumer
 };
 
-void rex_vm_exec(struct rex_vm *vm);
+void rex_vm_init(struct rex_vm *vm);
+
+// copies prog into m[] and verifies it. programs the verifier cannot prove safe still load, and run
+// with every range check in place.
+int  rex_vm_load(struct rex_vm *vm, const uint8_t *prog, uint16_t len);
+
+// runs until (fn-end), the end of the program, a fault, or until budget ops have executed.
+// returns enum rex_vm_status.
+int  rex_vm_exec(struct rex_vm *vm, int32_t budget);
+
+// consumer side of the response ring; call from at most one thread per VM.
+// pops the oldest response into dst and returns its length (one msgpack bin object), 0 when nothing is
+// queued, or -1 when it is longer than cap, in which case it stays queued.
+int  rex_vm_rsp_read(struct rex_vm *vm, uint8_t *dst, uint32_t cap);
+
+enum rex_chip_id {
+	REX_CHIP_WRAM = 0,
+	REX_CHIP_SRAM,
+	REX_CHIP_ROM,
+	REX_CHIP_2C00,
+
+	REX_CHIP_COUNT
+};
+
+// chips are addressed with 24-bit offsets; bytes at or past size read as 0 and ignore writes.
+struct rex_chip {
+	uint8_t   *mem;
+	uint32_t   size;
+	uint8_t    writable;
+};
+
+extern REX_TLS struct rex_chip rex_chips[REX_CHIP_COUNT];
 
 enum rex_vmop {
-	REX_VMOP_RETURN = 0,
-	REX_VMOP_GOTO,
-	REX_VMOP_IF,
-	
-	// TBD...
+	REX_VMOP_RETURN = 0,        // (fn-end)
+	REX_VMOP_GOTO,              // (jmp lbl)
+	REX_VMOP_IF,                // (jne x lbl)
+	REX_VMOP_IF_NOT,            // (jeq x lbl)
+	REX_VMOP_FN_START,          // (fn-start)
 
-	REX_VMOP_NOT,
+	REX_VMOP_DEF_VEC = 0x10,
+	REX_VMOP_VEC_ASSIGN,
+
+	REX_VMOP_CHIP_READ_U8 = 0x20,
+	REX_VMOP_CHIP_READ_U16,
+	REX_VMOP_CHIP_READ_U24,
+	REX_VMOP_CHIP_WRITE_U8,
+	REX_VMOP_CHIP_WRITE_U16,
+	REX_VMOP_CHIP_WRITE_U24,
+	REX_VMOP_CHIP_READ,
+	REX_VMOP_CHIP_WRITE,
+
+	REX_VMOP_RSP_WRITE_VEC = 0x30,
+
+	REX_VMOP_NOT = 0x40,
 	REX_VMOP_AND,
 	REX_VMOP_OR,
 	REX_VMOP_XOR,
@@ -130,4 +298,8 @@ enum rex_vmop {
 	REX_VMOP_LE_UNSIGNED,
 };
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,670 @@
+// body of the REX interpreter, included twice by rex_vm.c:
+//   REX_VM_CHECKED 1: every form, argument count, stack push, vector and jump is range checked
+//   REX_VM_CHECKED 0: for programs that passed rex_vm_verify(); those checks compile away
+
+static int REX_VM_EXEC(struct rex_vm *vm, int32_t budget)
+{
+	uint8_t    *m = vm->m;
+	uint16_t    p = vm->p;
+	uint16_t    s = vm->s;
+	uint16_t    f = vm->f;
+	const uint16_t d = vm->d;
+	int32_t     n = budget;
+
+	uint32_t    v = 0;
+	uint16_t    base = 0;
+	uint16_t    pf = 0;
+	uint8_t     op = 0;
+	uint8_t     argc = 0;
+	uint8_t     b;
+
+	if (vm->status == REX_VM_HALTED || vm->status == REX_VM_FAULT) {
+		vm->ops = 0;
+		return vm->status;
+	}
+
+#ifdef REX_VM_THREADED
+	// leading byte of every expression selects its form directly:
+	static const void *const forms[256] = {
+		[0x00 ... 0x7F] = &&f_u7,
+		[0x80]          = &&f_u16,
+		[0x81]          = &&f_u24,
+		[0x82]          = &&f_u32,
+		[0x83 ... 0x8F] = &&f_call,
+		[0x90 ... 0x9F] = &&f_ptr12,
+		[0xA0]          = &&f_ptr16,
+		[0xA1 ... 0xA3] = &&f_call_small,
+#  if REX_VM_CHECKED
+		[0xA4]          = &&f_bad,
+#  else
+		[0xA4]          = &&f_fused,            // REX_VM_FUSED_FORM
+#  endif
+		[0xA5 ... 0xAF] = &&f_bad,
+		[0xB0 ... 0xBF] = &&f_u12,
+		[0xC0 ... 0xFF] = &&f_bytes,
+	};
+
+#  if defined(__clang__)
+#    pragma clang diagnostic push
+#    pragma clang diagnostic ignored "-Winitializer-overrides"
+#  else
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Woverride-init"
+#  endif
+	static const void *const ops[256] = {
+		[0x00 ... 0xFF]              = &&op_bad,
+
+		[REX_VMOP_RETURN]            = &&op_return,
+		[REX_VMOP_GOTO]              = &&op_goto,
+		[REX_VMOP_IF]                = &&op_if,
+		[REX_VMOP_IF_NOT]            = &&op_if_not,
+		[REX_VMOP_FN_START]          = &&op_fn_start,
+
+		[REX_VMOP_DEF_VEC]           = &&op_def_vec,
+		[REX_VMOP_VEC_ASSIGN]        = &&op_vec_assign,
+
+		[REX_VMOP_CHIP_READ_U8]      = &&op_chip_read_u8,
+		[REX_VMOP_CHIP_READ_U16]     = &&op_chip_read_u16,
+		[REX_VMOP_CHIP_READ_U24]     = &&op_chip_read_u24,
+		[REX_VMOP_CHIP_WRITE_U8]     = &&op_chip_write_u8,
+		[REX_VMOP_CHIP_WRITE_U16]    = &&op_chip_write_u16,
+		[REX_VMOP_CHIP_WRITE_U24]    = &&op_chip_write_u24,
+		[REX_VMOP_CHIP_READ]         = &&op_chip_read,
+		[REX_VMOP_CHIP_WRITE]        = &&op_chip_write,
+
+		[REX_VMOP_RSP_WRITE_VEC]     = &&op_rsp_write_vec,
+
+		[REX_VMOP_NOT]               = &&op_not,
+		[REX_VMOP_AND]               = &&op_and,
+		[REX_VMOP_OR]                = &&op_or,
+		[REX_VMOP_XOR]               = &&op_xor,
+		[REX_VMOP_SHL]               = &&op_shl,
+		[REX_VMOP_SHR]               = &&op_shr,
+		[REX_VMOP_EQ]                = &&op_eq,
+		[REX_VMOP_NE]                = &&op_ne,
+		[REX_VMOP_ADD]               = &&op_add,
+		[REX_VMOP_SUB]               = &&op_sub,
+		[REX_VMOP_GT_SIGNED]         = &&op_gt_signed,
+		[REX_VMOP_LT_SIGNED]         = &&op_lt_signed,
+		[REX_VMOP_GE_SIGNED]         = &&op_ge_signed,
+		[REX_VMOP_LE_SIGNED]         = &&op_le_signed,
+		[REX_VMOP_GT_UNSIGNED]       = &&op_gt_unsigned,
+		[REX_VMOP_LT_UNSIGNED]       = &&op_lt_unsigned,
+		[REX_VMOP_GE_UNSIGNED]       = &&op_ge_unsigned,
+		[REX_VMOP_LE_UNSIGNED]       = &&op_le_unsigned,
+	};
+#  if defined(__clang__)
+#    pragma clang diagnostic pop
+#  else
+#    pragma GCC diagnostic pop
+#  endif
+
+#  define DISPATCH()    do { b = m[p]; goto *forms[b]; } while (0)
+#  define EXEC_OP()     goto *ops[op]
+#else
+#  define DISPATCH()    do { b = m[p]; goto dispatch; } while (0)
+#  define EXEC_OP()     goto exec_op
+#endif
+
+#define SAVE()              do { vm->p = p; vm->s = s; vm->f = f; vm->ops = (uint32_t)(budget - n); } while (0)
+#define FAULT(e)            do { vm->err = (e); vm->status = REX_VM_FAULT; SAVE(); return REX_VM_FAULT; } while (0)
+#define ARG(i)              rex_ld32(m + base - 4 * ((i) + 1))
+#define CHIP(i)             do { uint32_t id_ = ARG(i); if (id_ >= REX_CHIP_COUNT) FAULT(REX_VM_ERR_BAD_CHIP); c = &rex_chips[id_]; } while (0)
+
+#if REX_VM_CHECKED
+#define NEED_PROG(k)        do { if ((uint32_t)p + (k) > d) FAULT(REX_VM_ERR_PROGRAM_BOUNDS); } while (0)
+#define NEED_STACK()        do { if (s < (uint32_t)d + 4) FAULT(REX_VM_ERR_STACK_OVERFLOW); } while (0)
+#define NEED_ARGC(k)        do { if (argc != (k)) FAULT(REX_VM_ERR_BAD_ARGC); } while (0)
+#define NEED_ARGC_MIN(k)    do { if (argc < (k)) FAULT(REX_VM_ERR_BAD_ARGC); } while (0)
+#define NEED_BYTES(a)       do { if (((a) & 0xFFFF) + (((a) >> 16) & 0x3F) > d) FAULT(REX_VM_ERR_PROGRAM_BOUNDS); } while (0)
+#define VEC(i)              do { \
+		uint32_t ptr_ = ARG(i) & 0xFFFF; \
+		vi = (uint32_t)d + ptr_; \
+		if (vi + 4 > REX_VM_MEMSZ) FAULT(REX_VM_ERR_DATA_BOUNDS); \
+		cap = rex_ld16le(m + vi); \
+		if (vi + 4 + cap > REX_VM_MEMSZ) FAULT(REX_VM_ERR_DATA_BOUNDS); \
+	} while (0)
+#define JUMP(t)             do { \
+		uint32_t t_ = (t); \
+		if (t_ >= d) FAULT(REX_VM_ERR_PROGRAM_BOUNDS); \
+		p = (uint16_t)t_; \
+		s = REX_VM_MEMSZ; \
+		f = REX_VM_NOFRAME; \
+		goto statement_end; \
+	} while (0)
+#else
+// rex_vm_verify() has already proven all of these for every path through the program:
+#define NEED_PROG(k)        do { } while (0)
+#define NEED_STACK()        do { } while (0)
+#define NEED_ARGC(k)        do { } while (0)
+#define NEED_ARGC_MIN(k)    do { } while (0)
+#define NEED_BYTES(a)       do { } while (0)
+#define VEC(i)              do { \
+		vi = (uint32_t)d + (ARG(i) & 0xFFFF); \
+		cap = rex_ld16le(m + vi); \
+	} while (0)
+#define JUMP(t)             do { \
+		p = (uint16_t)(t); \
+		s = REX_VM_MEMSZ; \
+		f = REX_VM_NOFRAME; \
+		goto statement_end; \
+	} while (0)
+#endif
+
+	goto statement;
+
+#ifndef REX_VM_THREADED
+dispatch:
+	if (b < 0x80)       goto f_u7;
+	if (b == 0x80)      goto f_u16;
+	if (b == 0x81)      goto f_u24;
+	if (b == 0x82)      goto f_u32;
+	if (b < 0x90)       goto f_call;
+	if (b < 0xA0)       goto f_ptr12;
+	if (b == 0xA0)      goto f_ptr16;
+	if (b < 0xA4)       goto f_call_small;
+#  if !REX_VM_CHECKED
+	if (b == REX_VM_FUSED_FORM) goto f_fused;
+#  endif
+	if (b < 0xB0)       goto f_bad;
+	if (b < 0xC0)       goto f_u12;
+	goto f_bytes;
+#endif
+
+f_u7:
+	v = b;
+	p += 1;
+	goto value;
+
+f_u12:
+f_ptr12:
+	NEED_PROG(2);
+	v = ((uint32_t)(b & 0x0F) << 8) | m[p+1];
+	p += 2;
+	goto value;
+
+f_u16:
+f_ptr16:
+	NEED_PROG(3);
+	v = ((uint32_t)m[p+1] << 8) | m[p+2];
+	p += 3;
+	goto value;
+
+f_u24:
+	NEED_PROG(4);
+	v = ((uint32_t)m[p+1] << 16) | ((uint32_t)m[p+2] << 8) | m[p+3];
+	p += 4;
+	goto value;
+
+f_u32:
+	NEED_PROG(5);
+	v = ((uint32_t)m[p+1] << 24) | ((uint32_t)m[p+2] << 16) | ((uint32_t)m[p+3] << 8) | m[p+4];
+	p += 5;
+	goto value;
+
+f_bytes:
+	NEED_PROG(1 + (b & 0x3F));
+	v = REX_VAL_BYTES | ((uint32_t)(b & 0x3F) << 16) | (uint32_t)(p + 1);
+	p += 1 + (b & 0x3F);
+	goto value;
+
+f_call_small:
+	argc = b - 0xA1;
+	goto call;
+
+f_call:
+	argc = b & 0x0F;
+	goto call;
+
+f_bad:
+	FAULT(REX_VM_ERR_BAD_FORM);
+
+#if !REX_VM_CHECKED
+f_fused:
+	{
+		// only ever at a statement start, with an empty stack:
+		const struct rex_vm_fused *x = &vm->fused[m[p+1]];
+		const struct rex_chip *c = &rex_chips[x->chip];
+
+		if (x->kind == REX_VM_FUSED_BRANCH) {
+			int taken = ((rex_chip_read_le(c, x->offs, x->width) & x->mask) == x->value) == x->equal;
+
+			n -= x->ops;
+			if (!taken) {
+				p = x->next;
+				goto statement_end;
+			}
+			// a poll that branches to itself sees the same chip bytes until the slice ends, so spend the
+			// rest of the budget the way the loop would have without going round it:
+			if (x->target == p && n > 0) {
+				int32_t k = (n + x->ops - 1) / x->ops * x->ops;
+
+				vm->skipped += (uint32_t)k;
+				n -= k;
+			}
+			JUMP(x->target);
+		} else {
+			uint32_t vi = (uint32_t)d + x->target;
+			uint32_t cap = rex_ld16le(m + vi);
+			uint32_t cnt = x->value < cap ? x->value : cap;
+
+			rex_chip_read(c, x->offs, m + vi + 4, cnt);
+			rex_st16le(m + vi + 2, (uint16_t)cnt);
+
+			// the response is its own statement, so a budget that runs out in between still yields there:
+			if (--n <= 0) {
+				p = x->mid;
+				goto statement_end;
+			}
+			n--;
+			rex_rsp_send(vm, m + vi + 4, cnt);
+			p = x->next;
+			goto statement_end;
+		}
+	}
+#endif
+
+call:
+	NEED_PROG(2);
+	op = m[p+1];
+	p += 2;
+	if (argc == 0) {
+		base = s;
+		pf = f;
+		goto exec;
+	}
+
+	// push a pending call frame: op, argc<<4 | args left, previous frame
+	NEED_STACK();
+	s -= 4;
+	m[s+0] = op;
+	m[s+1] = (uint8_t)((argc << 4) | argc);
+	rex_st16le(m + s + 2, f);
+	f = s;
+	DISPATCH();
+
+value:
+	if (f == REX_VM_NOFRAME)
+		goto statement_end;
+
+	NEED_STACK();
+	s -= 4;
+	rex_st32(m + s, v);
+
+	if ((--m[f+1] & 0x0F) != 0)
+		DISPATCH();
+
+	// all arguments are evaluated; arg i lives at m[f - 4*(i+1)]:
+	base = f;
+	op = m[f];
+	argc = m[f+1] >> 4;
+	pf = rex_ld16le(m + f + 2);
+
+exec:
+	n--;
+	EXEC_OP();
+
+#ifndef REX_VM_THREADED
+exec_op:
+	switch (op) {
+		case REX_VMOP_RETURN:           goto op_return;
+		case REX_VMOP_GOTO:             goto op_goto;
+		case REX_VMOP_IF:               goto op_if;
+		case REX_VMOP_IF_NOT:           goto op_if_not;
+		case REX_VMOP_FN_START:         goto op_fn_start;
+		case REX_VMOP_DEF_VEC:          goto op_def_vec;
+		case REX_VMOP_VEC_ASSIGN:       goto op_vec_assign;
+		case REX_VMOP_CHIP_READ_U8:     goto op_chip_read_u8;
+		case REX_VMOP_CHIP_READ_U16:    goto op_chip_read_u16;
+		case REX_VMOP_CHIP_READ_U24:    goto op_chip_read_u24;
+		case REX_VMOP_CHIP_WRITE_U8:    goto op_chip_write_u8;
+		case REX_VMOP_CHIP_WRITE_U16:   goto op_chip_write_u16;
+		case REX_VMOP_CHIP_WRITE_U24:   goto op_chip_write_u24;
+		case REX_VMOP_CHIP_READ:        goto op_chip_read;
+		case REX_VMOP_CHIP_WRITE:       goto op_chip_write;
+		case REX_VMOP_RSP_WRITE_VEC:    goto op_rsp_write_vec;
+		case REX_VMOP_NOT:              goto op_not;
+		case REX_VMOP_AND:              goto op_and;
+		case REX_VMOP_OR:               goto op_or;
+		case REX_VMOP_XOR:              goto op_xor;
+		case REX_VMOP_SHL:              goto op_shl;
+		case REX_VMOP_SHR:              goto op_shr;
+		case REX_VMOP_EQ:               goto op_eq;
+		case REX_VMOP_NE:               goto op_ne;
+		case REX_VMOP_ADD:              goto op_add;
+		case REX_VMOP_SUB:              goto op_sub;
+		case REX_VMOP_GT_SIGNED:        goto op_gt_signed;
+		case REX_VMOP_LT_SIGNED:        goto op_lt_signed;
+		case REX_VMOP_GE_SIGNED:        goto op_ge_signed;
+		case REX_VMOP_LE_SIGNED:        goto op_le_signed;
+		case REX_VMOP_GT_UNSIGNED:      goto op_gt_unsigned;
+		case REX_VMOP_LT_UNSIGNED:      goto op_lt_unsigned;
+		case REX_VMOP_GE_UNSIGNED:      goto op_ge_unsigned;
+		case REX_VMOP_LE_UNSIGNED:      goto op_le_unsigned;
+		default:                        goto op_bad;
+	}
+#endif
+
+ret:
+	// pop the arguments and frame, then hand v to the enclosing call:
+	s = argc ? base + 4 : base;
+	f = pf;
+	goto value;
+
+statement_end:
+	if (n <= 0) {
+		vm->status = REX_VM_YIELD;
+		SAVE();
+		return REX_VM_YIELD;
+	}
+
+statement:
+	if (p >= d) {
+		vm->status = REX_VM_HALTED;
+		SAVE();
+		return REX_VM_HALTED;
+	}
+	DISPATCH();
+
+op_bad:
+	FAULT(REX_VM_ERR_BAD_OPCODE);
+
+op_return:
+	NEED_ARGC(0);
+	p = vm->e;
+	s = REX_VM_MEMSZ;
+	f = REX_VM_NOFRAME;
+	vm->status = REX_VM_YIELD;
+	SAVE();
+	return REX_VM_YIELD;
+
+op_goto:
+	NEED_ARGC(1);
+	JUMP(ARG(0));
+
+op_if:
+	NEED_ARGC(2);
+	if (ARG(0) != 0)
+		JUMP(ARG(1));
+	v = 0;
+	goto ret;
+
+op_if_not:
+	NEED_ARGC(2);
+	if (ARG(0) == 0)
+		JUMP(ARG(1));
+	v = 0;
+	goto ret;
+
+op_fn_start:
+	NEED_ARGC(0);
+	vm->e = p;
+	v = 0;
+	goto ret;
+
+op_def_vec:
+	{
+		uint32_t ptr, vi, cap;
+
+		NEED_ARGC(2);
+		ptr = ARG(0) & 0xFFFF;
+		cap = ARG(1);
+		vi = (uint32_t)d + ptr;
+#if REX_VM_CHECKED
+		if (cap > REX_VM_MEMSZ || vi + 4 + cap > REX_VM_MEMSZ)
+			FAULT(REX_VM_ERR_DATA_BOUNDS);
+#endif
+
+		rex_st16le(m + vi + 0, (uint16_t)cap);
+		rex_st16le(m + vi + 2, 0);
+		v = 0;
+		goto ret;
+	}
+
+op_vec_assign:
+	{
+		uint32_t vi, cap, len = 0;
+		uint8_t  i;
+
+		NEED_ARGC_MIN(1);
+		VEC(0);
+		for (i = 1; i < argc; i++) {
+			uint32_t a = ARG(i);
+			if (a & REX_VAL_BYTES) {
+				uint32_t bl = (a >> 16) & 0x3F;
+				// computed values may carry the bytes tag too, so this stays checked even when verified:
+				if ((a & 0xFFFF) + bl > d)
+					FAULT(REX_VM_ERR_PROGRAM_BOUNDS);
+				if (bl > cap - len)
+					bl = cap - len;
+				memcpy(m + vi + 4 + len, m + (a & 0xFFFF), bl);
+				len += bl;
+			} else if (len < cap) {
+				m[vi + 4 + len++] = (uint8_t)a;
+			}
+		}
+		rex_st16le(m + vi + 2, (uint16_t)len);
+		v = 0;
+		goto ret;
+	}
+
+op_chip_read_u8:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(2);
+		CHIP(0);
+		v = rex_chip_read_le(c, ARG(1), 1);
+		goto ret;
+	}
+
+op_chip_read_u16:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(2);
+		CHIP(0);
+		v = rex_chip_read_le(c, ARG(1), 2);
+		goto ret;
+	}
+
+op_chip_read_u24:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(2);
+		CHIP(0);
+		v = rex_chip_read_le(c, ARG(1), 3);
+		goto ret;
+	}
+
+op_chip_write_u8:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(3);
+		CHIP(0);
+		rex_chip_write_le(c, ARG(1), 1, ARG(2));
+		v = 0;
+		goto ret;
+	}
+
+op_chip_write_u16:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(3);
+		CHIP(0);
+		rex_chip_write_le(c, ARG(1), 2, ARG(2));
+		v = 0;
+		goto ret;
+	}
+
+op_chip_write_u24:
+	{
+		const struct rex_chip *c;
+
+		NEED_ARGC(3);
+		CHIP(0);
+		rex_chip_write_le(c, ARG(1), 3, ARG(2));
+		v = 0;
+		goto ret;
+	}
+
+op_chip_read:
+	{
+		const struct rex_chip *c;
+		uint32_t o, len, vi, cap, cnt;
+		uint8_t  i;
+
+		// (chip-read chip offs len dest...) fills each dest with the next len bytes:
+		NEED_ARGC_MIN(3);
+		CHIP(0);
+		o = ARG(1);
+		len = ARG(2);
+		for (i = 3; i < argc; i++) {
+			VEC(i);
+			cnt = len < cap ? len : cap;
+			rex_chip_read(c, o, m + vi + 4, cnt);
+			rex_st16le(m + vi + 2, (uint16_t)cnt);
+			o += len;
+		}
+		v = 0;
+		goto ret;
+	}
+
+op_chip_write:
+	{
+		const struct rex_chip *c;
+		uint32_t o, vi, cap, len;
+		uint8_t  i;
+
+		// (chip-write chip offs src...) writes each vector (or inline byte array) back to back:
+		NEED_ARGC_MIN(2);
+		CHIP(0);
+		o = ARG(1);
+		for (i = 2; i < argc; i++) {
+			uint32_t a = ARG(i);
+			const uint8_t *src;
+			if (a & REX_VAL_BYTES) {
+				NEED_BYTES(a);
+				src = m + (a & 0xFFFF);
+				len = (a >> 16) & 0x3F;
+			} else {
+				VEC(i);
+				src = m + vi + 4;
+				len = rex_ld16le(m + vi + 2);
+				if (len > cap)
+					len = cap;
+			}
+			rex_chip_write(c, o, src, len);
+			o += len;
+		}
+		v = 0;
+		goto ret;
+	}
+
+op_rsp_write_vec:
+	{
+		uint32_t vi, cap, len, total = 0;
+		uint8_t  i;
+		uint8_t  msg[REX_VM_MEMSZ + 8];
+		uint32_t used;
+
+		// (rsp-write-vec src...) sends all sources as one msgpack bin object:
+		NEED_ARGC_MIN(1);
+		for (i = 0; i < argc; i++) {
+			uint32_t a = ARG(i);
+			if (a & REX_VAL_BYTES) {
+				NEED_BYTES(a);
+				total += (a >> 16) & 0x3F;
+			} else {
+				VEC(i);
+				len = rex_ld16le(m + vi + 2);
+				total += len < cap ? len : cap;
+			}
+		}
+
+		// a response never needs to be larger than m[]:
+		if (total > REX_VM_MEMSZ)
+			FAULT(REX_VM_ERR_DATA_BOUNDS);
+
+		used = rex_st_bin_header(msg, total);
+		for (i = 0; i < argc; i++) {
+			uint32_t a = ARG(i);
+			if (a & REX_VAL_BYTES) {
+				len = (a >> 16) & 0x3F;
+				memcpy(msg + used, m + (a & 0xFFFF), len);
+			} else {
+				VEC(i);
+				len = rex_ld16le(m + vi + 2);
+				if (len > cap)
+					len = cap;
+				memcpy(msg + used, m + vi + 4, len);
+			}
+			used += len;
+		}
+
+		v = (uint32_t)rex_rsp_push(&vm->rsp, msg, used);
+		goto ret;
+	}
+
+#define REX_VM_UNARY(name, expr) \
+op_##name: \
+	{ \
+		uint32_t a; \
+		NEED_ARGC(1); \
+		a = ARG(0); \
+		v = (expr); \
+		goto ret; \
+	}
+
+#define REX_VM_BINARY(name, expr) \
+op_##name: \
+	{ \
+		uint32_t a, c; \
+		NEED_ARGC(2); \
+		a = ARG(0); \
+		c = ARG(1); \
+		v = (expr); \
+		goto ret; \
+	}
+
+	REX_VM_UNARY(not, ~a)
+	REX_VM_BINARY(and, a & c)
+	REX_VM_BINARY(or, a | c)
+	REX_VM_BINARY(xor, a ^ c)
+	REX_VM_BINARY(shl, a << (c & 31))
+	REX_VM_BINARY(shr, a >> (c & 31))
+	REX_VM_BINARY(eq, a == c)
+	REX_VM_BINARY(ne, a != c)
+	REX_VM_BINARY(add, a + c)
+	REX_VM_BINARY(sub, a - c)
+	REX_VM_BINARY(gt_signed, (int32_t)a > (int32_t)c)
+	REX_VM_BINARY(lt_signed, (int32_t)a < (int32_t)c)
+	REX_VM_BINARY(ge_signed, (int32_t)a >= (int32_t)c)
+	REX_VM_BINARY(le_signed, (int32_t)a <= (int32_t)c)
+	REX_VM_BINARY(gt_unsigned, a > c)
+	REX_VM_BINARY(lt_unsigned, a < c)
+	REX_VM_BINARY(ge_unsigned, a >= c)
+	REX_VM_BINARY(le_unsigned, a <= c)
+
+#undef REX_VM_UNARY
+#undef REX_VM_BINARY
+#undef SAVE
+#undef FAULT
+#undef NEED_PROG
+#undef NEED_STACK
+#undef NEED_ARGC
+#undef NEED_ARGC_MIN
+#undef NEED_BYTES
+#undef ARG
+#undef CHIP
+#undef VEC
+#undef JUMP
+#undef DISPATCH
+#undef EXEC_OP
+}
+
+#undef REX_VM_EXEC
+#undef REX_VM_CHECKED
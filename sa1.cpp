@@ -7,7 +7,7 @@
 #include "snes9x.h"
 #include "memmap.h"
 
-uint8	SA1OpenBus;
+S9X_TLS uint8	SA1OpenBus;
 
 static void S9xSA1SetBWRAMMemMap (uint8);
 static void S9xSetSA1MemMap (uint32, uint8);
@@ -84,10 +84,10 @@ static void S9xSA1SetBWRAMMemMap (uint8 val)
 	{
 		for (int c = 0; c < 0x400; c += 16)
 		{
-			SA1.Map[c + 6] = SA1.Map[c + 0x806] = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
-			SA1.Map[c + 7] = SA1.Map[c + 0x807] = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
-			SA1.WriteMap[c + 6] = SA1.WriteMap[c + 0x806] = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
-			SA1.WriteMap[c + 7] = SA1.WriteMap[c + 0x807] = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
+			SA1.Block[c + 6].Map = SA1.Block[c + 0x806].Map = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
+			SA1.Block[c + 7].Map = SA1.Block[c + 0x807].Map = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
+			SA1.Block[c + 6].WriteMap = SA1.Block[c + 0x806].WriteMap = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
+			SA1.Block[c + 7].WriteMap = SA1.Block[c + 0x807].WriteMap = (uint8 *) CMemory::MAP_BWRAM_BITMAP2;
 		}
 
 		SA1.BWRAM = Memory.SRAM + (val & 0x7f) * 0x2000 / 4;
@@ -96,10 +96,10 @@ static void S9xSA1SetBWRAMMemMap (uint8 val)
 	{
 		for (int c = 0; c < 0x400; c += 16)
 		{
-			SA1.Map[c + 6] = SA1.Map[c + 0x806] = (uint8 *) CMemory::MAP_BWRAM;
-			SA1.Map[c + 7] = SA1.Map[c + 0x807] = (uint8 *) CMemory::MAP_BWRAM;
-			SA1.WriteMap[c + 6] = SA1.WriteMap[c + 0x806] = (uint8 *) CMemory::MAP_BWRAM;
-			SA1.WriteMap[c + 7] = SA1.WriteMap[c + 0x807] = (uint8 *) CMemory::MAP_BWRAM;
+			SA1.Block[c + 6].Map = SA1.Block[c + 0x806].Map = (uint8 *) CMemory::MAP_BWRAM;
+			SA1.Block[c + 7].Map = SA1.Block[c + 0x807].Map = (uint8 *) CMemory::MAP_BWRAM;
+			SA1.Block[c + 6].WriteMap = SA1.Block[c + 0x806].WriteMap = (uint8 *) CMemory::MAP_BWRAM;
+			SA1.Block[c + 7].WriteMap = SA1.Block[c + 0x807].WriteMap = (uint8 *) CMemory::MAP_BWRAM;
 		}
 
 		SA1.BWRAM = Memory.SRAM + (val & 0x1f) * 0x2000;
@@ -146,7 +146,7 @@ static void S9xSetSA1MemMap (uint32 which1, uint8 map)
 				block = Memory.ROM + Multi.cartOffsetB + (((map & 7) - 4) * 0x100000 + (c << 12));
 		}
 		for (int i = c; i < c + 16; i++)
-			Memory.Map[start  + i] = SA1.Map[start  + i] = block;
+			Memory.Block[start  + i].Map = SA1.Block[start  + i].Map = block;
 	}
 
 	for (int c = 0; c < 0x200; c += 16)
@@ -173,7 +173,7 @@ static void S9xSetSA1MemMap (uint32 which1, uint8 map)
 			}
 		}
 		for (int i = c + 8; i < c + 16; i++)
-			Memory.Map[start2 + i] = SA1.Map[start2 + i] = block;
+			Memory.Block[start2 + i].Map = SA1.Block[start2 + i].Map = block;
 	}
 }
 
@@ -682,7 +682,7 @@ static void S9xSA1DMA (void)
 	switch (Memory.FillRAM[0x2230] & 3)
 	{
 		case 0: // ROM
-			s = SA1.Map[((src & 0xffffff) >> MEMMAP_SHIFT)];
+			s = SA1.Block[(src & 0xffffff) >> MEMMAP_SHIFT].Map;
 			if (s >= (uint8 *) CMemory::MAP_LAST)
 				s += (src & 0xffff);
 			else
@@ -760,7 +760,7 @@ static void S9xSA1ReadVariableLengthData (bool8 inc, bool8 no_shift)
 
 uint8 S9xSA1GetByte (uint32 address)
 {
-	uint8	*GetAddress = SA1.Map[(address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8	*GetAddress = SA1.Block[(address & 0xffffff) >> MEMMAP_SHIFT].Map;
 
 	if (GetAddress >= (uint8 *)CMemory::MAP_LAST)
 	{
@@ -770,6 +770,9 @@ uint8 S9xSA1GetByte (uint32 address)
 
 	switch ((pint) GetAddress)
 	{
+	#ifdef USE_REX
+		case CMemory::MAP_REX_2C00:
+	#endif
 		case CMemory::MAP_PPU:
 			SA1.Cycles += ONE_CYCLE;
 			return (S9xGetSA1(address & 0xffff));
@@ -834,7 +837,7 @@ uint16 S9xSA1GetWord (uint32 address, s9xwrap_t w)
 
 void S9xSA1SetByte (uint8 byte, uint32 address)
 {
-	uint8	*SetAddress = SA1.WriteMap[(address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8	*SetAddress = SA1.Block[(address & 0xffffff) >> MEMMAP_SHIFT].WriteMap;
 
 	if (SetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
@@ -844,6 +847,9 @@ void S9xSA1SetByte (uint8 byte, uint32 address)
 
 	switch ((pint) SetAddress)
 	{
+	#ifdef USE_REX
+		case CMemory::MAP_REX_2C00:
+	#endif
 		case CMemory::MAP_PPU:
 			S9xSetSA1(byte, address & 0xffff);
 			return;
@@ -942,7 +948,7 @@ void S9xSA1SetPCBase (uint32 address)
 
 	SA1.MemSpeedx2 = SA1.MemSpeed << 1;
 
-	uint8	*GetAddress = SA1.Map[(address & 0xffffff) >> MEMMAP_SHIFT];
+	uint8	*GetAddress = SA1.Block[(address & 0xffffff) >> MEMMAP_SHIFT].Map;
 
 	if (GetAddress >= (uint8 *) CMemory::MAP_LAST)
 	{
@@ -6,6 +6,7 @@
 
 #include "snes9x.h"
 #include "memmap.h"
+#include "profiler.h"
 
 #define CPU								SA1
 #define ICPU							SA1
@@ -160,6 +161,7 @@ void S9xSA1MainLoop (void)
 			Opcodes = S9xSA1OpcodesSlow;
 		}
 
+		PROFILE_OP(SA1Profile, SA1.Cycles, Registers.PBPC, Op);
 		Registers.PCw++;
 		(*Opcodes[Op].S9xOpcode)();
 	}
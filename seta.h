@@ -48,9 +48,9 @@ struct SST018
 	uint8	output[512];
 };
 
-extern struct SST010	ST010;
-extern struct SST011	ST011;
-extern struct SST018	ST018;
+extern S9X_TLS struct SST010	ST010;
+extern S9X_TLS struct SST011	ST011;
+extern S9X_TLS struct SST018	ST018;
 
 uint8 S9xGetST010 (uint32);
 void S9xSetST010 (uint32, uint8);
@@ -61,7 +61,7 @@ void S9xSetST018 (uint8, uint32);
 uint8 S9xGetSetaDSP (uint32);
 void S9xSetSetaDSP (uint8, uint32);
 
-extern uint8 (*GetSETA) (uint32);
-extern void (*SetSETA) (uint32, uint8);
+extern S9X_TLS uint8 (*GetSETA) (uint32);
+extern S9X_TLS void (*SetSETA) (uint32, uint8);
 
 #endif
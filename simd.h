@@ -0,0 +1,145 @@
+/*****************************************************************************\
+     Snes9x - Portable Super Nintendo Entertainment System (TM) emulator.
+                This file is licensed under the Snes9x License.
+   For further information, consult the LICENSE file in the root directory.
+\*****************************************************************************/
+
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+#include "port.h"
+
+// Eight 16-bit lanes and the handful of operations the renderer needs on them, over SSE2 or NEON.
+// Comparisons give all ones or all zeros per lane, for VSelect. VMin, VAddSat and VSubSat are unsigned.
+// Then sixteen 8-bit lanes for the tile converters: V8Test gives all ones where a & m is not zero, m having one bit
+// set per lane, and V8SpreadRows takes two bitplanes of eight rows, row r's bytes at p[2r] and p[2r + 1], and fills
+// eight lanes with each byte, so out[0] holds the first plane of rows 0 and 1, out[1] the second, out[2] the first
+// plane of rows 2 and 3 and so on. Last, four 32-bit lanes for the Mode 7 coordinates, where V32Sar shifts in the sign.
+
+#if defined(S9X_SIMD_SSE2)
+
+#include <emmintrin.h>
+
+typedef __m128i	v16x8;
+
+static alwaysinline v16x8 VLoad (const uint16 *p)			{ return _mm_loadu_si128((const __m128i *) p); }
+static alwaysinline void VStore (uint16 *p, v16x8 v)		{ _mm_storeu_si128((__m128i *) p, v); }
+static alwaysinline v16x8 VLoad8 (const uint8 *p)			{ return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), _mm_setzero_si128()); }
+static alwaysinline v16x8 VSplat (uint16 n)					{ return _mm_set1_epi16((short) n); }
+static alwaysinline v16x8 VAnd (v16x8 a, v16x8 b)			{ return _mm_and_si128(a, b); }
+static alwaysinline v16x8 VAndNot (v16x8 a, v16x8 b)		{ return _mm_andnot_si128(a, b); }
+static alwaysinline v16x8 VOr (v16x8 a, v16x8 b)			{ return _mm_or_si128(a, b); }
+static alwaysinline v16x8 VAdd (v16x8 a, v16x8 b)			{ return _mm_add_epi16(a, b); }
+static alwaysinline v16x8 VAddSat (v16x8 a, v16x8 b)		{ return _mm_adds_epu16(a, b); }
+static alwaysinline v16x8 VSubSat (v16x8 a, v16x8 b)		{ return _mm_subs_epu16(a, b); }
+static alwaysinline v16x8 VMin (v16x8 a, v16x8 b)			{ return _mm_sub_epi16(a, _mm_subs_epu16(a, b)); }
+static alwaysinline v16x8 VEq (v16x8 a, v16x8 b)			{ return _mm_cmpeq_epi16(a, b); }
+static alwaysinline v16x8 VSelect (v16x8 m, v16x8 a, v16x8 b)	{ return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+// lanes 0, 0, 2, 2, 4, 4, 6, 6
+static alwaysinline v16x8 VPairs (v16x8 a)					{ return _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0)); }
+template<int n> static alwaysinline v16x8 VShl (v16x8 a)	{ return _mm_slli_epi16(a, n); }
+template<int n> static alwaysinline v16x8 VShr (v16x8 a)	{ return _mm_srli_epi16(a, n); }
+
+typedef __m128i	v8x16;
+
+static alwaysinline v8x16 V8Load (const uint8 *p)			{ return _mm_loadu_si128((const __m128i *) p); }
+static alwaysinline void V8Store (uint8 *p, v8x16 v)		{ _mm_storeu_si128((__m128i *) p, v); }
+static alwaysinline v8x16 V8Splat (uint8 n)					{ return _mm_set1_epi8((char) n); }
+static alwaysinline v8x16 V8And (v8x16 a, v8x16 b)			{ return _mm_and_si128(a, b); }
+static alwaysinline v8x16 V8Or (v8x16 a, v8x16 b)			{ return _mm_or_si128(a, b); }
+static alwaysinline v8x16 V8Test (v8x16 a, v8x16 m)			{ return _mm_cmpeq_epi8(_mm_and_si128(a, m), m); }
+
+static alwaysinline void V8SpreadRows (const uint8 *p, v8x16 out[8])
+{
+	__m128i	d  = _mm_loadu_si128((const __m128i *) p);
+	__m128i	lo = _mm_unpacklo_epi8(d, d);
+	__m128i	hi = _mm_unpackhi_epi8(d, d);
+	__m128i	q[4] = { _mm_unpacklo_epi16(lo, lo), _mm_unpackhi_epi16(lo, lo), _mm_unpacklo_epi16(hi, hi), _mm_unpackhi_epi16(hi, hi) };
+
+	for (int k = 0; k < 4; k++)
+	{
+		__m128i	a = _mm_unpacklo_epi32(q[k], q[k]);
+		__m128i	b = _mm_unpackhi_epi32(q[k], q[k]);
+		out[2 * k]     = _mm_unpacklo_epi64(a, b);
+		out[2 * k + 1] = _mm_unpackhi_epi64(a, b);
+	}
+}
+
+typedef __m128i	v32x4;
+
+static alwaysinline v32x4 V32Load (const int32 *p)			{ return _mm_loadu_si128((const __m128i *) p); }
+static alwaysinline void V32Store (uint32 *p, v32x4 v)		{ _mm_storeu_si128((__m128i *) p, v); }
+static alwaysinline v32x4 V32Splat (int32 n)				{ return _mm_set1_epi32(n); }
+static alwaysinline v32x4 V32And (v32x4 a, v32x4 b)			{ return _mm_and_si128(a, b); }
+static alwaysinline v32x4 V32Or (v32x4 a, v32x4 b)			{ return _mm_or_si128(a, b); }
+static alwaysinline v32x4 V32Add (v32x4 a, v32x4 b)			{ return _mm_add_epi32(a, b); }
+static alwaysinline v32x4 V32Eq (v32x4 a, v32x4 b)			{ return _mm_cmpeq_epi32(a, b); }
+template<int n> static alwaysinline v32x4 V32Shl (v32x4 a)	{ return _mm_slli_epi32(a, n); }
+template<int n> static alwaysinline v32x4 V32Shr (v32x4 a)	{ return _mm_srli_epi32(a, n); }
+template<int n> static alwaysinline v32x4 V32Sar (v32x4 a)	{ return _mm_srai_epi32(a, n); }
+
+#elif defined(S9X_SIMD_NEON)
+
+#include <arm_neon.h>
+
+typedef uint16x8_t	v16x8;
+
+static alwaysinline v16x8 VLoad (const uint16 *p)			{ return vld1q_u16(p); }
+static alwaysinline void VStore (uint16 *p, v16x8 v)		{ vst1q_u16(p, v); }
+static alwaysinline v16x8 VLoad8 (const uint8 *p)			{ return vmovl_u8(vld1_u8(p)); }
+static alwaysinline v16x8 VSplat (uint16 n)					{ return vdupq_n_u16(n); }
+static alwaysinline v16x8 VAnd (v16x8 a, v16x8 b)			{ return vandq_u16(a, b); }
+static alwaysinline v16x8 VAndNot (v16x8 a, v16x8 b)		{ return vbicq_u16(b, a); }
+static alwaysinline v16x8 VOr (v16x8 a, v16x8 b)			{ return vorrq_u16(a, b); }
+static alwaysinline v16x8 VAdd (v16x8 a, v16x8 b)			{ return vaddq_u16(a, b); }
+static alwaysinline v16x8 VAddSat (v16x8 a, v16x8 b)		{ return vqaddq_u16(a, b); }
+static alwaysinline v16x8 VSubSat (v16x8 a, v16x8 b)		{ return vqsubq_u16(a, b); }
+static alwaysinline v16x8 VMin (v16x8 a, v16x8 b)			{ return vminq_u16(a, b); }
+static alwaysinline v16x8 VEq (v16x8 a, v16x8 b)			{ return vceqq_u16(a, b); }
+static alwaysinline v16x8 VSelect (v16x8 m, v16x8 a, v16x8 b)	{ return vbslq_u16(m, a, b); }
+// lanes 0, 0, 2, 2, 4, 4, 6, 6
+static alwaysinline v16x8 VPairs (v16x8 a)					{ return vtrnq_u16(a, a).val[0]; }
+template<int n> static alwaysinline v16x8 VShl (v16x8 a)	{ return vshlq_n_u16(a, n); }
+template<int n> static alwaysinline v16x8 VShr (v16x8 a)	{ return vshrq_n_u16(a, n); }
+
+typedef uint8x16_t	v8x16;
+
+static alwaysinline v8x16 V8Load (const uint8 *p)			{ return vld1q_u8(p); }
+static alwaysinline void V8Store (uint8 *p, v8x16 v)		{ vst1q_u8(p, v); }
+static alwaysinline v8x16 V8Splat (uint8 n)					{ return vdupq_n_u8(n); }
+static alwaysinline v8x16 V8And (v8x16 a, v8x16 b)			{ return vandq_u8(a, b); }
+static alwaysinline v8x16 V8Or (v8x16 a, v8x16 b)			{ return vorrq_u8(a, b); }
+static alwaysinline v8x16 V8Test (v8x16 a, v8x16 m)			{ return vtstq_u8(a, m); }
+
+static alwaysinline void V8SpreadRows (const uint8 *p, v8x16 out[8])
+{
+	uint8x8x2_t	d = vld2_u8(p);
+
+	#define SPREAD(k) \
+		out[2 * (k)]     = vcombine_u8(vdup_lane_u8(d.val[0], 2 * (k)), vdup_lane_u8(d.val[0], 2 * (k) + 1)); \
+		out[2 * (k) + 1] = vcombine_u8(vdup_lane_u8(d.val[1], 2 * (k)), vdup_lane_u8(d.val[1], 2 * (k) + 1));
+
+	SPREAD(0);
+	SPREAD(1);
+	SPREAD(2);
+	SPREAD(3);
+
+	#undef SPREAD
+}
+
+typedef int32x4_t	v32x4;
+
+static alwaysinline v32x4 V32Load (const int32 *p)			{ return vld1q_s32(p); }
+static alwaysinline void V32Store (uint32 *p, v32x4 v)		{ vst1q_u32(p, vreinterpretq_u32_s32(v)); }
+static alwaysinline v32x4 V32Splat (int32 n)				{ return vdupq_n_s32(n); }
+static alwaysinline v32x4 V32And (v32x4 a, v32x4 b)			{ return vandq_s32(a, b); }
+static alwaysinline v32x4 V32Or (v32x4 a, v32x4 b)			{ return vorrq_s32(a, b); }
+static alwaysinline v32x4 V32Add (v32x4 a, v32x4 b)			{ return vaddq_s32(a, b); }
+static alwaysinline v32x4 V32Eq (v32x4 a, v32x4 b)			{ return vreinterpretq_s32_u32(vceqq_s32(a, b)); }
+template<int n> static alwaysinline v32x4 V32Shl (v32x4 a)	{ return vshlq_n_s32(a, n); }
+template<int n> static alwaysinline v32x4 V32Shr (v32x4 a)	{ return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), n)); }
+template<int n> static alwaysinline v32x4 V32Sar (v32x4 a)	{ return vshrq_n_s32(a, n); }
+
+#endif
+
+#endif
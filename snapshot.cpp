@@ -19,6 +19,8 @@
 #include "display.h"
 #include "language.h"
 #include "gfx.h"
+#include "profiler.h"
+#include "renderthread.h"
 
 #ifndef min
 #define min(a,b)	(((a) < (b)) ? (a) : (b))
@@ -170,7 +172,7 @@ struct SnapshotScreenshotInfo
 	uint8	Data[MAX_SNES_WIDTH * MAX_SNES_HEIGHT * 3];
 };
 
-static struct Obsolete
+static S9X_TLS struct Obsolete
 {
 	uint8	CPU_IRQActive;
 }	Obsolete;
@@ -1005,7 +1007,7 @@ static void SkipBlockWithName(STREAM stream, const char *name);
 
 void S9xResetSaveTimer (bool8 dontsave)
 {
-	static time_t	t = -1;
+	static S9X_TLS time_t	t = -1;
 
 	if (!Settings.DontSaveOopsSnapshot && !dontsave && t != -1 && time(NULL) - t > 300)
 	{
@@ -1172,6 +1174,11 @@ void S9xFreezeToStream (STREAM stream)
 	char	buffer[8192];
 	uint8	*soundsnapshot = new uint8[SPC_SAVE_STATE_BLOCK_SIZE];
 
+#ifdef S9X_THREADED_RENDER
+	// the screenshot block reads the screen
+	S9xRenderThreadSync();
+#endif
+
 	sprintf(buffer, "%s:%04d\n", SNAPSHOT_MAGIC, SNAPSHOT_VERSION);
 	WRITE_STREAM(buffer, strlen(buffer), stream);
 
@@ -1322,6 +1329,11 @@ int S9xUnfreezeFromStream (STREAM stream)
 	int		version, len;
 	char	buffer[PATH_MAX + 1];
 
+#ifdef S9X_THREADED_RENDER
+	// loading clears or replaces the screen
+	S9xRenderThreadSync();
+#endif
+
 	len = strlen(SNAPSHOT_MAGIC) + 1 + 4 + 1;
 	if (READ_STREAM(buffer, len, stream) != (unsigned int ) len)
 		return (WRONG_FORMAT);
@@ -1699,6 +1711,10 @@ int S9xUnfreezeFromStream (STREAM stream)
 		ICPU.ShiftedDB = Registers.DB << 16;
 		S9xSetPCBase(Registers.PBPC);
 		S9xUnpackStatus();
+		S9xResetIdleLoop();
+	#ifdef CPU_PROFILER
+		S9xProfileResync();
+	#endif
 		if(version < SNAPSHOT_VERSION_IRQ_2018)
 			S9xUpdateIRQPositions(false); // calculate the new trigger pos from saved PPU data
 		S9xFixCycles();
@@ -1714,6 +1730,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 		S9xBuildDirectColourMaps();
 		IPPU.ColorsChanged = TRUE;
 		IPPU.OBJChanged = TRUE;
+		IPPU.OBJDirty[0] = IPPU.OBJDirty[1] = ~(uint64) 0;
 		IPPU.RenderThisFrame = TRUE;
 
 		GFX.DoInterlace = 0;
@@ -1759,7 +1776,7 @@ int S9xUnfreezeFromStream (STREAM stream)
 		if (local_movie_data)
 		{
 			// restore last displayed pad_read status
-			extern bool8	pad_read, pad_read_last;
+			extern S9X_TLS bool8	pad_read, pad_read_last;
 			bool8			pad_read_temp = pad_read;
 
 			pad_read = pad_read_last;
@@ -267,6 +267,8 @@ void S9xLoadConfigFiles (char **argv, int argc)
 	else
 		Settings.SkipFrames = conf.GetUInt("Settings::FrameSkip", 0) + 1;
 
+	Settings.RunAheadFrames             =  conf.GetUInt("Settings::RunAheadFrames",            0);
+
 	// Controls
 
 	Settings.MouseMaster                =  conf.GetBool("Controls::MouseMaster",               true);
@@ -428,6 +430,7 @@ void S9xUsage (void)
 	// OTHER OPTIONS
 	S9xMessage(S9X_INFO, S9X_USAGE, "-frameskip <num>                Screen update frame skip rate");
 	S9xMessage(S9X_INFO, S9X_USAGE, "-frametime <num>                Milliseconds per frame for frameskip auto-adjust");
+	S9xMessage(S9X_INFO, S9X_USAGE, "-runahead <num>                 Show <num> frames ahead to hide the game's input lag");
 	S9xMessage(S9X_INFO, S9X_USAGE, "-upanddown                      Override protection from pressing left+right or");
 	S9xMessage(S9X_INFO, S9X_USAGE, "                                up+down together");
 	S9xMessage(S9X_INFO, S9X_USAGE, "-conf <filename>                Use specified conf file (after standard files)");
@@ -724,6 +727,14 @@ char * S9xParseArgs (char **argv, int argc)
 					S9xUsage();
 			}
 			else
+			if (!strcasecmp(argv[i], "-runahead"))
+			{
+				if (i + 1 < argc)
+					Settings.RunAheadFrames = atoi(argv[++i]);
+				else
+					S9xUsage();
+			}
+			else
 			if (!strcasecmp(argv[i], "-upanddown"))
 				Settings.UpAndDown = TRUE;
 			else
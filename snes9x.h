@@ -112,6 +112,7 @@
 #define SINGLE_STEP_FLAG	(1 <<  2)	// debugger
 #define BREAK_FLAG			(1 <<  3)	// debugger
 #define SCAN_KEYS_FLAG		(1 <<  4)	// CPU
+#define RUN_FOR_FLAG		(1 <<  5)	// CPU
 #define HALTED_FLAG			(1 << 12)	// APU
 #define FRAME_ADVANCE_FLAG	(1 <<  9)
 
@@ -154,7 +155,13 @@ enum
 	HC_HCOUNTER_MAX_EVENT = 3,
 	HC_HDMA_INIT_EVENT    = 4,
 	HC_RENDER_EVENT       = 5,
-	HC_WRAM_REFRESH_EVENT = 6
+	HC_WRAM_REFRESH_EVENT = 6,
+	HC_REX_EVENT          = 7,
+	HC_SUPERFX_EVENT      = 8,
+	HC_SA1_EVENT          = 9,
+	HC_RUN_FOR_EVENT      = 10,
+
+	HC_EVENT_COUNT
 };
 
 enum
@@ -281,6 +288,7 @@ struct SSettings
 	uint32	HighSpeedSeek;
 	bool8	FrameAdvance;
 	bool8	Rewinding;
+	uint32	RunAheadFrames;
 
 	bool8	NetPlay;
 	bool8	NetPlayServer;
@@ -314,12 +322,16 @@ struct SSettings
 	int	OneSlowClockCycle;
 	int	TwoClockCycles;
 	int	MaxSpriteTilesPerLine;
+	bool8	CPUBlockCache;
+	int32	SA1SyncCycles;	// 0: run the SA-1 after every CPU instruction
+	int8	SkipIdleLoops;	// 0: never, 1: titles on the allow list, 2: all titles but the deny list
 };
 
 struct SSNESGameFixes
 {
 	uint8	SRAMInitialValue;
 	uint8	Uniracers;
+	int8	IdleLoops;		// 1: allow idle loop skipping, -1: deny it
 };
 
 enum
@@ -339,10 +351,10 @@ void S9xClearPause(uint32);
 void S9xExit(void);
 void S9xMessage(int, int, const char *);
 
-extern struct SSettings			Settings;
-extern struct SCPUState			CPU;
-extern struct STimings			Timings;
-extern struct SSNESGameFixes	SNESGameFixes;
-extern char						String[513];
+extern S9X_TLS struct SSettings			Settings;
+extern S9X_TLS struct SCPUState			CPU;
+extern S9X_TLS struct STimings			Timings;
+extern S9X_TLS struct SSNESGameFixes	SNESGameFixes;
+extern S9X_TLS char						String[513];
 
 #endif
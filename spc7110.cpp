@@ -39,7 +39,7 @@
 #include "spc7110emu.h"
 #include "spc7110emu.cpp"
 
-SPC7110	s7emu;
+S9X_TLS SPC7110	s7emu;
 
 static void SetSPC7110SRAMMap (uint8);
 
@@ -59,17 +59,17 @@ static void SetSPC7110SRAMMap (uint8 newstate)
 {
 	if (newstate & 0x80)
 	{
-		Memory.Map[0x006] = (uint8 *) Memory.MAP_HIROM_SRAM;
-		Memory.Map[0x007] = (uint8 *) Memory.MAP_HIROM_SRAM;
-		Memory.Map[0x306] = (uint8 *) Memory.MAP_HIROM_SRAM;
-		Memory.Map[0x307] = (uint8 *) Memory.MAP_HIROM_SRAM;
+		Memory.Block[0x006].Map = (uint8 *) Memory.MAP_HIROM_SRAM;
+		Memory.Block[0x007].Map = (uint8 *) Memory.MAP_HIROM_SRAM;
+		Memory.Block[0x306].Map = (uint8 *) Memory.MAP_HIROM_SRAM;
+		Memory.Block[0x307].Map = (uint8 *) Memory.MAP_HIROM_SRAM;
 	}
 	else
 	{
-		Memory.Map[0x006] = (uint8 *) Memory.MAP_RONLY_SRAM;
-		Memory.Map[0x007] = (uint8 *) Memory.MAP_RONLY_SRAM;
-		Memory.Map[0x306] = (uint8 *) Memory.MAP_RONLY_SRAM;
-		Memory.Map[0x307] = (uint8 *) Memory.MAP_RONLY_SRAM;
+		Memory.Block[0x006].Map = (uint8 *) Memory.MAP_RONLY_SRAM;
+		Memory.Block[0x007].Map = (uint8 *) Memory.MAP_RONLY_SRAM;
+		Memory.Block[0x306].Map = (uint8 *) Memory.MAP_RONLY_SRAM;
+		Memory.Block[0x307].Map = (uint8 *) Memory.MAP_RONLY_SRAM;
 	}
 }
 
@@ -90,7 +90,7 @@ struct SSPC7110Snapshot
 	}	context[32];
 };
 
-extern struct SSPC7110Snapshot	s7snap;
+extern S9X_TLS struct SSPC7110Snapshot	s7snap;
 
 void S9xInitSPC7110 (void);
 void S9xResetSPC7110 (void);
@@ -5,16 +5,99 @@
 \*****************************************************************************/
 
 #include "tileimpl.h"
+#include "simd.h"
 
 using namespace TileImpl;
 
 namespace {
 
-	uint32	pixbit[8][16];
-	uint8	hrbit_odd[256];
-	uint8	hrbit_even[256];
+	S9X_TLS uint32	pixbit[8][16];
+	S9X_TLS uint8	hrbit_odd[256];
+	S9X_TLS uint8	hrbit_even[256];
 
-	// Here are the tile converters, selected by S9xSelectTileConverter().
+	// Here are the tile converters, called by UpdateTileCache() for the tiles that VRAM writes have marked.
+	// The hires ones take the left half of each tile from TileAddr and the right half from NextAddr.
+
+#ifdef S9X_SIMD
+	static const uint8	PixelBits[16] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+
+	// Two rows at a time: every lane of a row gets the row's plane bytes, and the lane for pixel x keeps bit 7 - x of each.
+	template<int planes>
+	static alwaysinline uint8 ConvertPlanes (uint8 *pCache, const uint8 *tp)
+	{
+		const v8x16	bits = V8Load(PixelBits);
+		v8x16		pix[4];
+		uint64		non_zero[2];
+
+		for (int k = 0; k < 4; k++)
+			pix[k] = V8Splat(0);
+
+		for (int p = 0; p < planes; p += 2)
+		{
+			v8x16	rows[8];
+
+			V8SpreadRows(tp + p * 8, rows);
+
+			for (int k = 0; k < 4; k++)
+				pix[k] = V8Or(pix[k], V8Or(V8And(V8Test(rows[2 * k], bits), V8Splat(1 << p)),
+										   V8And(V8Test(rows[2 * k + 1], bits), V8Splat(2 << p))));
+		}
+
+		for (int k = 0; k < 4; k++)
+			V8Store(pCache + k * 16, pix[k]);
+
+		V8Store((uint8 *) non_zero, V8Or(V8Or(pix[0], pix[1]), V8Or(pix[2], pix[3])));
+
+		return ((non_zero[0] | non_zero[1]) ? TRUE : BLANK_TILE);
+	}
+
+	// The hires tiles are made up into plane bytes first, the left four pixels from one tile and the right four from the next.
+	template<int planes>
+	static alwaysinline uint8 ConvertHiresPlanes (uint8 *pCache, const uint8 *tp1, const uint8 *tp2, const uint8 *hrbit)
+	{
+		uint8	tp[planes * 8];
+
+		for (int i = 0; i < planes * 8; i++)
+			tp[i] = (hrbit[tp1[i]] << 4) | hrbit[tp2[i]];
+
+		return (ConvertPlanes<planes>(pCache, tp));
+	}
+
+	uint8 ConvertTile2 (uint8 *pCache, uint32 TileAddr, uint32)
+	{
+		return (ConvertPlanes<2>(pCache, &Memory.VRAM[TileAddr]));
+	}
+
+	uint8 ConvertTile4 (uint8 *pCache, uint32 TileAddr, uint32)
+	{
+		return (ConvertPlanes<4>(pCache, &Memory.VRAM[TileAddr]));
+	}
+
+	uint8 ConvertTile8 (uint8 *pCache, uint32 TileAddr, uint32)
+	{
+		return (ConvertPlanes<8>(pCache, &Memory.VRAM[TileAddr]));
+	}
+
+	uint8 ConvertTile2h_odd (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
+	{
+		return (ConvertHiresPlanes<2>(pCache, &Memory.VRAM[TileAddr], &Memory.VRAM[NextAddr], hrbit_odd));
+	}
+
+	uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
+	{
+		return (ConvertHiresPlanes<4>(pCache, &Memory.VRAM[TileAddr], &Memory.VRAM[NextAddr], hrbit_odd));
+	}
+
+	uint8 ConvertTile2h_even (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
+	{
+		return (ConvertHiresPlanes<2>(pCache, &Memory.VRAM[TileAddr], &Memory.VRAM[NextAddr], hrbit_even));
+	}
+
+	uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
+	{
+		return (ConvertHiresPlanes<4>(pCache, &Memory.VRAM[TileAddr], &Memory.VRAM[NextAddr], hrbit_even));
+	}
+#else
 	// Really, except for the definition of DOBIT and the number of times it is called, they're all the same.
 
 	#define DOBIT(n, i) \
@@ -109,18 +192,14 @@ namespace {
 		if ((pix = hrbit_odd[*(tp2 + (n))])) \
 			p2 |= pixbit[(i)][pix];
 
-	uint8 ConvertTile2h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
+	uint8 ConvertTile2h_odd (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
 	{
-		uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
+		uint8	*tp1     = &Memory.VRAM[TileAddr];
+		uint8	*tp2     = &Memory.VRAM[NextAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
 		uint8			line;
 
-		if (Tile == 0x3ff)
-			tp2 = tp1 - (0x3ff << 4);
-		else
-			tp2 = tp1 + (1 << 4);
-
 		for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 		{
 			uint32			p1 = 0;
@@ -137,18 +216,14 @@ namespace {
 		return (non_zero ? TRUE : BLANK_TILE);
 	}
 
-	uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 Tile)
+	uint8 ConvertTile4h_odd (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
 	{
-		uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
+		uint8	*tp1     = &Memory.VRAM[TileAddr];
+		uint8	*tp2     = &Memory.VRAM[NextAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
 		uint8			line;
 
-		if (Tile == 0x3ff)
-			tp2 = tp1 - (0x3ff << 5);
-		else
-			tp2 = tp1 + (1 << 5);
-
 		for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 		{
 			uint32			p1 = 0;
@@ -175,18 +250,14 @@ namespace {
 		if ((pix = hrbit_even[*(tp2 + (n))])) \
 			p2 |= pixbit[(i)][pix];
 
-	uint8 ConvertTile2h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
+	uint8 ConvertTile2h_even (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
 	{
-		uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
+		uint8	*tp1     = &Memory.VRAM[TileAddr];
+		uint8	*tp2     = &Memory.VRAM[NextAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
 		uint8			line;
 
-		if (Tile == 0x3ff)
-			tp2 = tp1 - (0x3ff << 4);
-		else
-			tp2 = tp1 + (1 << 4);
-
 		for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 		{
 			uint32			p1 = 0;
@@ -203,18 +274,14 @@ namespace {
 		return (non_zero ? TRUE : BLANK_TILE);
 	}
 
-	uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 Tile)
+	uint8 ConvertTile4h_even (uint8 *pCache, uint32 TileAddr, uint32 NextAddr)
 	{
-		uint8	*tp1     = &Memory.VRAM[TileAddr], *tp2;
+		uint8	*tp1     = &Memory.VRAM[TileAddr];
+		uint8	*tp2     = &Memory.VRAM[NextAddr];
 		uint32			*p       = (uint32 *) pCache;
 		uint32			non_zero = 0;
 		uint8			line;
 
-		if (Tile == 0x3ff)
-			tp2 = tp1 - (0x3ff << 5);
-		else
-			tp2 = tp1 + (1 << 5);
-
 		for (line = 8; line != 0; line--, tp1 += 2, tp2 += 2)
 		{
 			uint32			p1 = 0;
@@ -235,6 +302,105 @@ namespace {
 
 	#undef DOBIT
 
+#endif
+
+	// indexed by TILE_2BIT and the rest
+	uint8 (* const TileConverters[7]) (uint8 *, uint32, uint32) =
+	{
+		ConvertTile2, ConvertTile4, ConvertTile8, ConvertTile2h_even, ConvertTile2h_odd, ConvertTile4h_even, ConvertTile4h_odd
+	};
+
+	const uint8	TileShifts[7] = { 4, 5, 6, 4, 4, 5, 5 };
+
+	static alwaysinline void MarkTile (int t, uint32 n)
+	{
+		IPPU.TileDirty[t][n >> 6] |= (uint64) 1 << (n & 63);
+		IPPU.TileDirtyWords[t] |= (uint64) 1 << (n >> 6);
+	}
+
+	// Passes the 16-byte units VRAM writes have marked on to the tiles of every cache that are made from them.
+	// A hires tile also takes its right half from the tile after it, so the one before each unit is marked too.
+	void SpreadVRAMWrites (void)
+	{
+		uint64	words = IPPU.VRAMDirtyWords;
+
+		IPPU.VRAMDirtyWords = 0;
+
+		for (uint32 w = 0; words; w++, words >>= 1)
+		{
+			if (!(words & 1))
+				continue;
+
+			uint64	bits = IPPU.VRAMDirty[w];
+
+			IPPU.VRAMDirty[w] = 0;
+
+			for (uint32 u = w << 6; bits; u++, bits >>= 1)
+			{
+				if (!(bits & 1))
+					continue;
+
+				for (int t = 0; t < 7; t++)
+				{
+					uint32	n = u >> (TileShifts[t] - 4);
+
+					MarkTile(t, n);
+					if (t >= TILE_2BIT_EVEN)
+						MarkTile(t, (n - 1) & ((0x10000 >> TileShifts[t]) - 1));
+				}
+			}
+		}
+	}
+
+	// Converts every marked tile of cache t, so drawing from it never has to. base is where a hires layer's characters
+	// start: tile 0x3ff there takes its right half from the first tile at base rather than the one after it.
+	void UpdateTileCache (int t, uint32 base)
+	{
+		uint32	shift = TileShifts[t];
+		uint32	mask  = (0x10000 >> shift) - 1;
+		uint32	wrap  = ~0u;
+
+		if (IPPU.VRAMDirtyWords)
+			SpreadVRAMWrites();
+
+		if (t >= TILE_2BIT_EVEN)
+		{
+			base >>= shift;
+			wrap = (base + 0x3ff) & mask;
+
+			if (IPPU.TileWrapBase[t] != base)
+			{
+				if (IPPU.TileWrapBase[t] <= mask)
+					MarkTile(t, (IPPU.TileWrapBase[t] + 0x3ff) & mask);
+				IPPU.TileWrapBase[t] = base;
+				MarkTile(t, wrap);
+			}
+			else
+			if (IPPU.TileDirty[t][base >> 6] & ((uint64) 1 << (base & 63)))
+				MarkTile(t, wrap);
+		}
+
+		uint64	words = IPPU.TileDirtyWords[t];
+
+		IPPU.TileDirtyWords[t] = 0;
+
+		for (uint32 w = 0; words && w <= (mask >> 6); w++, words >>= 1)
+		{
+			if (!(words & 1))
+				continue;
+
+			uint64	bits = IPPU.TileDirty[t][w];
+
+			IPPU.TileDirty[t][w] = 0;
+
+			for (uint32 n = w << 6; bits; n++, bits >>= 1)
+			{
+				if (bits & 1)
+					IPPU.TileCached[t][n] = TileConverters[t](IPPU.TileCache[t] + (n << 6), n << shift, ((n == wrap) ? base : (n + 1) & mask) << shift);
+			}
+		}
+	}
+
 } // anonymous namespace
 
 void S9xInitTileRenderer (void)
@@ -296,6 +462,40 @@ void S9xInitTileRenderer (void)
 	}
 }
 
+// Which of the Renderers functions does the colour math set in $2130/$2131, 0 when there is none.
+static int ColourMathMode (void)
+{
+	int	i;
+
+	if (!Settings.Transparency)
+		i = 0;
+	else
+	{
+		i = (Memory.FillRAM[0x2131] & 0x80) ? 4 : 1;
+		if (Memory.FillRAM[0x2131] & 0x40)
+		{
+			i++;
+			if (Memory.FillRAM[0x2130] & 2)
+				i++;
+		}
+		if (IPPU.MaxBrightness != 0xf)
+		{
+			if (i == 1)
+				i = 7;
+			else if (i == 3)
+				i = 8;
+		}
+
+	}
+
+	return (i);
+}
+
+#ifdef S9X_SIMD
+// main screen drawn with the Deferred plotters, for S9xApplyColourMath to finish
+static S9X_TLS bool8	MathDeferred;
+#endif
+
 // Functions to select which converter and renderer to use.
 extern template struct TileImpl::Renderers<DrawTile16, Normal1x1>;
 extern template struct TileImpl::Renderers<DrawClippedTile16, Normal1x1>;
@@ -330,6 +530,29 @@ extern template struct TileImpl::Renderers<DrawTile16, HiresInterlace>;
 extern template struct TileImpl::Renderers<DrawClippedTile16, HiresInterlace>;
 extern template struct TileImpl::Renderers<DrawMosaicPixel16, HiresInterlace>;
 
+#ifdef S9X_SIMD
+extern template struct TileImpl::DeferredRenderers<DrawTile16, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawClippedTile16, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMosaicPixel16, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawBackdrop16, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7MosaicBG1, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7BG1, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7MosaicBG2, Deferred1x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7BG2, Deferred1x1>;
+
+extern template struct TileImpl::DeferredRenderers<DrawTile16, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawClippedTile16, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMosaicPixel16, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawBackdrop16, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7MosaicBG1, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7BG1, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7MosaicBG2, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawMode7BG2, Deferred2x1>;
+extern template struct TileImpl::DeferredRenderers<DrawTile16, DeferredInterlace>;
+extern template struct TileImpl::DeferredRenderers<DrawClippedTile16, DeferredInterlace>;
+extern template struct TileImpl::DeferredRenderers<DrawMosaicPixel16, DeferredInterlace>;
+#endif
+
 void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 {
 	void	(**DT)		(uint32, uint32, uint32, uint32);
@@ -345,7 +568,46 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 
 	bool8 interlace = obj ? FALSE : IPPU.Interlace;
 	bool8 hires = !sub && (BGMode == 5 || BGMode == 6 || IPPU.PseudoHires);
+	int	i = ColourMathMode();
 
+#ifdef S9X_SIMD
+	if (!sub && MathDeferred)		// main screen, math done per line
+	{
+		if (!IPPU.DoubleWidthPixels)
+		{
+			DT     = DeferredRenderers<DrawTile16, Deferred1x1>::Functions;
+			DCT    = DeferredRenderers<DrawClippedTile16, Deferred1x1>::Functions;
+			DMP    = DeferredRenderers<DrawMosaicPixel16, Deferred1x1>::Functions;
+			DB     = DeferredRenderers<DrawBackdrop16, Deferred1x1>::Functions;
+			DM7BG1 = M7M1 ? DeferredRenderers<DrawMode7MosaicBG1, Deferred1x1>::Functions : DeferredRenderers<DrawMode7BG1, Deferred1x1>::Functions;
+			DM7BG2 = M7M2 ? DeferredRenderers<DrawMode7MosaicBG2, Deferred1x1>::Functions : DeferredRenderers<DrawMode7BG2, Deferred1x1>::Functions;
+			GFX.LinesPerTile = 8;
+		}
+		else if (interlace)
+		{
+			DT     = DeferredRenderers<DrawTile16, DeferredInterlace>::Functions;
+			DCT    = DeferredRenderers<DrawClippedTile16, DeferredInterlace>::Functions;
+			DMP    = DeferredRenderers<DrawMosaicPixel16, DeferredInterlace>::Functions;
+			DB     = DeferredRenderers<DrawBackdrop16, Deferred2x1>::Functions;
+			DM7BG1 = M7M1 ? DeferredRenderers<DrawMode7MosaicBG1, Deferred2x1>::Functions : DeferredRenderers<DrawMode7BG1, Deferred2x1>::Functions;
+			DM7BG2 = M7M2 ? DeferredRenderers<DrawMode7MosaicBG2, Deferred2x1>::Functions : DeferredRenderers<DrawMode7BG2, Deferred2x1>::Functions;
+			GFX.LinesPerTile = 4;
+		}
+		else
+		{
+			DT     = DeferredRenderers<DrawTile16, Deferred2x1>::Functions;
+			DCT    = DeferredRenderers<DrawClippedTile16, Deferred2x1>::Functions;
+			DMP    = DeferredRenderers<DrawMosaicPixel16, Deferred2x1>::Functions;
+			DB     = DeferredRenderers<DrawBackdrop16, Deferred2x1>::Functions;
+			DM7BG1 = M7M1 ? DeferredRenderers<DrawMode7MosaicBG1, Deferred2x1>::Functions : DeferredRenderers<DrawMode7BG1, Deferred2x1>::Functions;
+			DM7BG2 = M7M2 ? DeferredRenderers<DrawMode7MosaicBG2, Deferred2x1>::Functions : DeferredRenderers<DrawMode7BG2, Deferred2x1>::Functions;
+			GFX.LinesPerTile = 8;
+		}
+
+		i = 1;
+	}
+	else
+#endif
 	if (!IPPU.DoubleWidthPixels)	// normal width
 	{
 		DT     = Renderers<DrawTile16, Normal1x1>::Functions;
@@ -410,29 +672,6 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 	GFX.DrawMode7BG1Nomath    = DM7BG1[0];
 	GFX.DrawMode7BG2Nomath    = DM7BG2[0];
 
-	int	i;
-
-	if (!Settings.Transparency)
-		i = 0;
-	else
-	{
-		i = (Memory.FillRAM[0x2131] & 0x80) ? 4 : 1;
-		if (Memory.FillRAM[0x2131] & 0x40)
-		{
-			i++;
-			if (Memory.FillRAM[0x2130] & 2)
-				i++;
-		}
-		if (IPPU.MaxBrightness != 0xf)
-		{
-			if (i == 1)
-				i = 7;
-			else if (i == 3)
-				i = 8;
-		}
-
-	}
-
 	GFX.DrawTileMath        = DT[i];
 	GFX.DrawClippedTileMath = DCT[i];
 	GFX.DrawMosaicPixelMath = DMP[i];
@@ -441,12 +680,21 @@ void S9xSelectTileRenderers (int BGMode, bool8 sub, bool8 obj)
 	GFX.DrawMode7BG2Math    = DM7BG2[i];
 }
 
+void S9xResetTileCache (void)
+{
+	memset(IPPU.VRAMDirty, 0, sizeof(IPPU.VRAMDirty));
+	IPPU.VRAMDirtyWords = 0;
+	memset(IPPU.TileDirty, 0xff, sizeof(IPPU.TileDirty));
+	memset(IPPU.TileDirtyWords, 0xff, sizeof(IPPU.TileDirtyWords));
+	memset(IPPU.TileWrapBase, 0xff, sizeof(IPPU.TileWrapBase));
+}
+
 void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 {
 	switch (depth)
 	{
 		case 8:
-			BG.ConvertTile      = BG.ConvertTileFlip = ConvertTile8;
+			UpdateTileCache(TILE_8BIT, 0);
 			BG.Buffer           = BG.BufferFlip      = IPPU.TileCache[TILE_8BIT];
 			BG.Buffered         = BG.BufferedFlip    = IPPU.TileCached[TILE_8BIT];
 			BG.TileShift        = 6;
@@ -459,28 +707,27 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 		case 4:
 			if (hires)
 			{
+				UpdateTileCache(TILE_4BIT_EVEN, BG.TileAddress);
+				UpdateTileCache(TILE_4BIT_ODD, BG.TileAddress);
+
 				if (sub || mosaic)
 				{
-					BG.ConvertTile     = ConvertTile4h_even;
 					BG.Buffer          = IPPU.TileCache[TILE_4BIT_EVEN];
 					BG.Buffered        = IPPU.TileCached[TILE_4BIT_EVEN];
-					BG.ConvertTileFlip = ConvertTile4h_odd;
 					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_ODD];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_ODD];
 				}
 				else
 				{
-					BG.ConvertTile     = ConvertTile4h_odd;
 					BG.Buffer          = IPPU.TileCache[TILE_4BIT_ODD];
 					BG.Buffered        = IPPU.TileCached[TILE_4BIT_ODD];
-					BG.ConvertTileFlip = ConvertTile4h_even;
 					BG.BufferFlip      = IPPU.TileCache[TILE_4BIT_EVEN];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT_EVEN];
 				}
 			}
 			else
 			{
-				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile4;
+				UpdateTileCache(TILE_4BIT, 0);
 				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_4BIT];
 				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_4BIT];
 			}
@@ -495,28 +742,27 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 		case 2:
 			if (hires)
 			{
+				UpdateTileCache(TILE_2BIT_EVEN, BG.TileAddress);
+				UpdateTileCache(TILE_2BIT_ODD, BG.TileAddress);
+
 				if (sub || mosaic)
 				{
-					BG.ConvertTile     = ConvertTile2h_even;
 					BG.Buffer          = IPPU.TileCache[TILE_2BIT_EVEN];
 					BG.Buffered        = IPPU.TileCached[TILE_2BIT_EVEN];
-					BG.ConvertTileFlip = ConvertTile2h_odd;
 					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_ODD];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_ODD];
 				}
 				else
 				{
-					BG.ConvertTile     = ConvertTile2h_odd;
 					BG.Buffer          = IPPU.TileCache[TILE_2BIT_ODD];
 					BG.Buffered        = IPPU.TileCached[TILE_2BIT_ODD];
-					BG.ConvertTileFlip = ConvertTile2h_even;
 					BG.BufferFlip      = IPPU.TileCache[TILE_2BIT_EVEN];
 					BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT_EVEN];
 				}
 			}
 			else
 			{
-				BG.ConvertTile = BG.ConvertTileFlip = ConvertTile2;
+				UpdateTileCache(TILE_2BIT, 0);
 				BG.Buffer      = BG.BufferFlip      = IPPU.TileCache[TILE_2BIT];
 				BG.Buffered    = BG.BufferedFlip    = IPPU.TileCached[TILE_2BIT];
 			}
@@ -529,3 +775,259 @@ void S9xSelectTileConverter (int depth, bool8 hires, bool8 sub, bool8 mosaic)
 			break;
 	}
 }
+
+#ifdef S9X_SIMD
+// Colour math over whole lines, eight pixels at a time. The kernels give the same result as COLOR_ADD, COLOR_SUB and
+// COLOR_ADD_BRIGHTNESS for every pair of pixel values, but work on each channel on its own, so a saturating add or
+// subtract and a minimum stand in for the carry tricks that need more than 16 bits.
+
+namespace {
+
+	static alwaysinline v16x8 GreenLowBit (v16x8 v)
+	{
+	#if GREEN_SHIFT_BITS == 6
+		v = VOr(v, VShr<5>(VAnd(v, VSplat(0x0400))));
+	#endif
+		return v;
+	}
+
+	struct VECTOR_ADD
+	{
+		static alwaysinline v16x8 fn(v16x8 C1, v16x8 C2)
+		{
+			const v16x8 r = VSplat(0x1f << RED_SHIFT_BITS), g = VSplat(0x1f << GREEN_SHIFT_BITS), b = VSplat(0x1f);
+
+			return GreenLowBit(VOr(VOr(VMin(VAddSat(VAnd(C1, r), VAnd(C2, r)), r),
+									   VMin(VAddSat(VAnd(C1, g), VAnd(C2, g)), g)),
+									   VMin(VAddSat(VAnd(C1, b), VAnd(C2, b)), b)));
+		}
+
+		// both sides have their low bits cleared, so each can be halved before the add
+		static alwaysinline v16x8 fn1_2(v16x8 C1, v16x8 C2)
+		{
+			const v16x8 low = VSplat(RGB_LOW_BITS_MASK);
+
+			return VOr(VAdd(VAdd(VShr<1>(VAndNot(low, C1)), VShr<1>(VAndNot(low, C2))), VAnd(VAnd(C1, C2), low)), VSplat(ALPHA_BITS_MASK));
+		}
+	};
+
+	struct VECTOR_SUB
+	{
+		static alwaysinline v16x8 fn(v16x8 C1, v16x8 C2)
+		{
+			const v16x8 r = VSplat(FIRST_COLOR_MASK), g = VSplat(SECOND_COLOR_MASK), b = VSplat(THIRD_COLOR_MASK);
+
+			return GreenLowBit(VOr(VOr(VSubSat(VAnd(C1, r), VAnd(C2, r)),
+									   VAnd(VSubSat(VAnd(C1, g), VAnd(C2, g)), VSplat(0x1f << GREEN_SHIFT_BITS))),
+									   VSubSat(VAnd(C1, b), VAnd(C2, b))));
+		}
+
+		// GFX.ZERO[] of the same index: each channel keeps its low bits if its high bit is set, else is zero
+		static alwaysinline v16x8 fn1_2(v16x8 C1, v16x8 C2)
+		{
+			const v16x8 rh = VSplat(RED_HI_BIT_MASK), gh = VSplat(GREEN_HI_BIT_MASK), bh = VSplat(BLUE_HI_BIT_MASK);
+			v16x8 x = VSubSat(VOr(VShr<1>(C1), VSplat(RGB_HI_BITS_MASK)), VShr<1>(VAndNot(VSplat(RGB_LOW_BITS_MASK), C2)));
+
+			return VAnd(x, VOr(VOr(VAnd(VEq(VAnd(x, rh), rh), VSplat(FIRST_COLOR_MASK & ~RED_HI_BIT_MASK)),
+								   VAnd(VEq(VAnd(x, gh), gh), VSplat(SECOND_COLOR_MASK & ~GREEN_HI_BIT_MASK))),
+								   VAnd(VEq(VAnd(x, bh), bh), VSplat(THIRD_COLOR_MASK & ~BLUE_HI_BIT_MASK))));
+		}
+	};
+
+	struct VECTOR_ADD_BRIGHTNESS
+	{
+		static alwaysinline v16x8 fn(v16x8 C1, v16x8 C2)
+		{
+			const v16x8 cap = VSplat(brightness_cap[0x3f]), mask = VSplat(0x1f);
+			v16x8 r = VMin(VAdd(VShr<RED_SHIFT_BITS>(C1), VShr<RED_SHIFT_BITS>(C2)), cap);
+			v16x8 g = VMin(VAdd(VAnd(VShr<GREEN_SHIFT_BITS>(C1), mask), VAnd(VShr<GREEN_SHIFT_BITS>(C2), mask)), cap);
+			v16x8 b = VMin(VAdd(VAnd(C1, mask), VAnd(C2, mask)), cap);
+			v16x8 v = VOr(VOr(VShl<RED_SHIFT_BITS>(r), VShl<GREEN_SHIFT_BITS>(g)), b);
+		#if GREEN_SHIFT_BITS == 6
+			v = VOr(v, VShl<1>(VAnd(g, VSplat(0x10))));
+		#endif
+			return v;
+		}
+
+		static alwaysinline v16x8 fn1_2(v16x8 C1, v16x8 C2)
+		{
+			return VECTOR_ADD::fn1_2(C1, C2);
+		}
+	};
+
+	// the blends of REGMATH, MATHF1_2 and MATHS1_2
+	enum { MATH_REG, MATH_F1_2, MATH_S1_2 };
+
+	typedef void (*MathLine_t) (uint16 *, const uint16 *, const uint8 *, const uint8 *, int);
+
+	// In double width the plotters take the subscreen pixel on the left of each pair for both, so Pairs does too.
+	template<class Op, int Blend, bool Pairs>
+	void MathLine (uint16 *S, const uint16 *Sub, const uint8 *SubZ, const uint8 *Tag, int Width)
+	{
+		const v16x8 fixed = VSplat(GFX.FixedColour), zero = VSplat(0), sd = VSplat(0x20), clipped = VSplat(2);
+
+		for (int x = 0; x < Width; x += 8)
+		{
+			uint64	t;
+
+			memcpy(&t, Tag + x, sizeof(t));
+			if (!t)
+				continue;
+
+			v16x8 tag = VLoad8(Tag + x);
+			v16x8 pix = VLoad(S + x);
+			v16x8 sub = VLoad(Sub + x);
+			v16x8 z = VLoad8(SubZ + x);
+			if (Pairs)
+			{
+				sub = VPairs(sub);
+				z = VPairs(z);
+			}
+
+			v16x8 clip = VEq(tag, clipped);
+			v16x8 subsel = VEq(VAnd(z, sd), sd);
+			v16x8 other = VSelect(subsel, sub, fixed);
+			v16x8 res;
+
+			switch (Blend)
+			{
+				case MATH_REG:
+					res = Op::fn(pix, other);
+					break;
+
+				case MATH_F1_2:
+					res = VSelect(clip, Op::fn(pix, fixed), Op::fn1_2(pix, fixed));
+					break;
+
+				case MATH_S1_2:
+				default:
+					res = VSelect(VAndNot(clip, subsel), Op::fn1_2(pix, other), Op::fn(pix, other));
+					break;
+			}
+
+			VStore(S + x, VSelect(VEq(tag, zero), pix, res));
+		}
+	}
+
+	// indexed as Renderers::Functions
+	const MathLine_t MathLines[2][9] =
+	{
+		{
+			NULL,
+			MathLine<VECTOR_ADD, MATH_REG, false>,
+			MathLine<VECTOR_ADD, MATH_F1_2, false>,
+			MathLine<VECTOR_ADD, MATH_S1_2, false>,
+			MathLine<VECTOR_SUB, MATH_REG, false>,
+			MathLine<VECTOR_SUB, MATH_F1_2, false>,
+			MathLine<VECTOR_SUB, MATH_S1_2, false>,
+			MathLine<VECTOR_ADD_BRIGHTNESS, MATH_REG, false>,
+			MathLine<VECTOR_ADD_BRIGHTNESS, MATH_S1_2, false>
+		},
+		{
+			NULL,
+			MathLine<VECTOR_ADD, MATH_REG, true>,
+			MathLine<VECTOR_ADD, MATH_F1_2, true>,
+			MathLine<VECTOR_ADD, MATH_S1_2, true>,
+			MathLine<VECTOR_SUB, MATH_REG, true>,
+			MathLine<VECTOR_SUB, MATH_F1_2, true>,
+			MathLine<VECTOR_SUB, MATH_S1_2, true>,
+			MathLine<VECTOR_ADD_BRIGHTNESS, MATH_REG, true>,
+			MathLine<VECTOR_ADD_BRIGHTNESS, MATH_S1_2, true>
+		}
+	};
+}
+
+// Called before the main screen of a range is drawn: outside hires, when any layer may do colour math, its pixels are
+// tagged as they are drawn and the math is done afterwards by S9xApplyColourMath.
+void S9xStartColourMath (void)
+{
+	MathDeferred = ColourMathMode() && (Memory.FillRAM[0x2131] & 0x3f) && !(PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires);
+
+	if (MathDeferred)
+		for (uint32 l = GFX.StartY; l <= GFX.EndY; l++)
+			memset(GFX.MathTag + l * GFX.PPL, 0, IPPU.RenderedScreenWidth);
+}
+
+void S9xApplyColourMath (void)
+{
+	if (!MathDeferred)
+		return;
+
+	MathLine_t	Blend = MathLines[IPPU.DoubleWidthPixels ? 1 : 0][ColourMathMode()];
+	uint32		Offset = GFX.StartY * GFX.PPL;
+
+	for (uint32 l = GFX.StartY; l <= GFX.EndY; l++, Offset += GFX.PPL)
+		Blend(GFX.S + Offset, GFX.SubScreen + Offset, GFX.SubZBuffer + Offset, GFX.MathTag + Offset, IPPU.RenderedScreenWidth);
+}
+
+// One line of a Mode 7 BG, four pixels at a time: the vector steps the coordinates and works out where the tile map
+// byte and the pixel are, leaving only the two VRAM reads per pixel. Outside the 1024x1024 map the tile is 0 when
+// Mode7Repeat is 3, and otherwise the pixel is left 0, which the plotters never draw.
+
+namespace {
+
+	template<int repeat>
+	void FetchMode7Line (uint8 *b, int count, int AA, int BB, int CC, int DD, int aa, int cc)
+	{
+		const int32	start_x[4] = { AA + BB, AA + BB + aa, AA + BB + 2 * aa, AA + BB + 3 * aa };
+		const int32	start_y[4] = { CC + DD, CC + DD + cc, CC + DD + 2 * cc, CC + DD + 3 * cc };
+
+		v32x4		x  = V32Load(start_x);
+		v32x4		y  = V32Load(start_y);
+		const v32x4	dx = V32Splat(4 * aa);
+		const v32x4	dy = V32Splat(4 * cc);
+
+		const uint8	*VRAM  = Memory.VRAM;
+		const uint8	*VRAM1 = Memory.VRAM + 1;
+		uint32		addr[4];
+
+		for (int i = 0; i < count; i += 4, x = V32Add(x, dx), y = V32Add(y, dy))
+		{
+			v32x4	X = V32Sar<8>(x);
+			v32x4	Y = V32Sar<8>(y);
+			v32x4	inside = V32Eq(V32And(V32Or(X, Y), V32Splat(~0x3ff)), V32Splat(0));
+
+			X = V32And(X, V32Splat(0x3ff));
+			Y = V32And(Y, V32Splat(0x3ff));
+
+			// the tile map byte in bits 0-15, the pixel's offset in its tile in bits 16-23 and whether it is inside the map in the top 8
+			v32x4	map = V32Add(V32Shl<5>(V32And(Y, V32Splat(~7))), V32And(V32Shr<2>(X), V32Splat(~1)));
+			v32x4	pix = V32Add(V32Shl<4>(V32And(Y, V32Splat(7))), V32Shl<1>(V32And(X, V32Splat(7))));
+
+			V32Store(addr, V32Or(V32Or(map, V32Shl<16>(pix)), repeat ? V32Shl<24>(inside) : V32Splat(0)));
+
+			for (int j = 0; j < 4; j++)
+			{
+				uint32	a = addr[j];
+
+				if (repeat == 0)
+					b[i + j] = VRAM1[(VRAM[a & 0xffff] << 7) + (a >> 16)];
+				else
+				if (repeat == 3)
+					b[i + j] = VRAM1[((VRAM[a & 0xffff] & (a >> 24)) << 7) + ((a >> 16) & 0xff)];
+				else
+					b[i + j] = VRAM1[(VRAM[a & 0xffff] << 7) + ((a >> 16) & 0xff)] & (a >> 24);
+			}
+		}
+	}
+}
+
+// b[] is filled four at a time, so it needs room for count rounded up to a multiple of four.
+void S9xFetchMode7Line (uint8 *b, int count, int AA, int BB, int CC, int DD, int aa, int cc)
+{
+	switch (PPU.Mode7Repeat)
+	{
+		case 0:
+			FetchMode7Line<0>(b, count, AA, BB, CC, DD, aa, cc);
+			break;
+
+		case 3:
+			FetchMode7Line<3>(b, count, AA, BB, CC, DD, aa, cc);
+			break;
+
+		default:
+			FetchMode7Line<2>(b, count, AA, BB, CC, DD, aa, cc);
+			break;
+	}
+}
+#endif
@@ -10,5 +10,10 @@
 void S9xInitTileRenderer (void);
 void S9xSelectTileRenderers (int, bool8, bool8);
 void S9xSelectTileConverter (int, bool8, bool8, bool8);
+#ifdef S9X_SIMD
+void S9xStartColourMath (void);
+void S9xApplyColourMath (void);
+void S9xFetchMode7Line (uint8 *, int, int, int, int, int, int, int);
+#endif
 
 #endif
@@ -31,4 +31,29 @@ namespace TileImpl {
 	template struct Renderers<DrawMode7MosaicBG2, Normal1x1>;
 	template struct Renderers<DrawMode7BG2, Normal1x1>;
 
+#ifdef S9X_SIMD
+	template<class MATH, class BPSTART>
+	void Deferred1x1Base<MATH, BPSTART>::Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2)
+	{
+		(void) OffsetInLine;
+		if (Z1 > GFX.DB[Offset + N] && (M))
+		{
+			GFX.S[Offset + N] = GFX.ScreenColors[Pix];
+			GFX.MathTag[Offset + N] = MATH::Tag();
+			GFX.DB[Offset + N] = Z2;
+		}
+	}
+
+
+	// normal width, math done per line
+	template struct DeferredRenderers<DrawTile16, Deferred1x1>;
+	template struct DeferredRenderers<DrawClippedTile16, Deferred1x1>;
+	template struct DeferredRenderers<DrawMosaicPixel16, Deferred1x1>;
+	template struct DeferredRenderers<DrawBackdrop16, Deferred1x1>;
+	template struct DeferredRenderers<DrawMode7MosaicBG1, Deferred1x1>;
+	template struct DeferredRenderers<DrawMode7BG1, Deferred1x1>;
+	template struct DeferredRenderers<DrawMode7MosaicBG2, Deferred1x1>;
+	template struct DeferredRenderers<DrawMode7BG2, Deferred1x1>;
+#endif
+
 } // namespace TileImpl
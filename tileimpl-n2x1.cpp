@@ -41,4 +41,34 @@ namespace TileImpl {
 	//template struct Renderers<DrawMode7MosaicBG2, Normal2x1>;
 	//template struct Renderers<DrawMode7BG2, Normal2x1>;
 
+#ifdef S9X_SIMD
+	template<class MATH, class BPSTART>
+	void Deferred2x1Base<MATH, BPSTART>::Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2)
+	{
+		(void) OffsetInLine;
+		if (Z1 > GFX.DB[Offset + 2 * N] && (M))
+		{
+			GFX.S[Offset + 2 * N] = GFX.S[Offset + 2 * N + 1] = GFX.ScreenColors[Pix];
+			GFX.MathTag[Offset + 2 * N] = GFX.MathTag[Offset + 2 * N + 1] = MATH::Tag();
+			GFX.DB[Offset + 2 * N] = GFX.DB[Offset + 2 * N + 1] = Z2;
+		}
+	}
+
+
+	// normal double width, math done per line
+	template struct DeferredRenderers<DrawTile16, Deferred2x1>;
+	template struct DeferredRenderers<DrawClippedTile16, Deferred2x1>;
+	template struct DeferredRenderers<DrawMosaicPixel16, Deferred2x1>;
+	template struct DeferredRenderers<DrawBackdrop16, Deferred2x1>;
+	template struct DeferredRenderers<DrawMode7MosaicBG1, Deferred2x1>;
+	template struct DeferredRenderers<DrawMode7BG1, Deferred2x1>;
+	template struct DeferredRenderers<DrawMode7MosaicBG2, Deferred2x1>;
+	template struct DeferredRenderers<DrawMode7BG2, Deferred2x1>;
+
+	// normal double width interlace, math done per line
+	template struct DeferredRenderers<DrawTile16, DeferredInterlace>;
+	template struct DeferredRenderers<DrawClippedTile16, DeferredInterlace>;
+	template struct DeferredRenderers<DrawMosaicPixel16, DeferredInterlace>;
+#endif
+
 } // namespace TileImpl
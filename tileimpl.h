@@ -11,7 +11,7 @@
 #include "ppu.h"
 #include "tile.h"
 
-extern struct SLineMatrixData	LineMatrixData[240];
+extern S9X_TLS struct SLineMatrixData	LineMatrixData[240];
 
 
 namespace TileImpl {
@@ -83,6 +83,37 @@ namespace TileImpl {
 	template<class MATH>
 	struct HiresInterlace : public HiresBase<MATH, BPInterlace> {};
 
+#ifdef S9X_SIMD
+	// Main screen plotters for when S9xApplyColourMath does the colour math over whole lines once every layer is drawn.
+	// Pixels go down unblended, and GFX.MathTag keeps whether each one is to be mathed and if it was colour clipped.
+	// Not for hires, where the math of a pixel depends on its neighbour on the main screen.
+	template<class MATH, class BPSTART>
+	struct Deferred1x1Base
+	{
+		enum { Pitch = BPSTART::Pitch };
+		typedef BPSTART bpstart_t;
+
+		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+	};
+
+	template<class MATH>
+	struct Deferred1x1 : public Deferred1x1Base<MATH, BPProgressive> {};
+
+	template<class MATH, class BPSTART>
+	struct Deferred2x1Base
+	{
+		enum { Pitch = BPSTART::Pitch };
+		typedef BPSTART bpstart_t;
+
+		static void Draw(int N, int M, uint32 Offset, uint32 OffsetInLine, uint8 Pix, uint8 Z1, uint8 Z2);
+	};
+
+	template<class MATH>
+	struct Deferred2x1 : public Deferred2x1Base<MATH, BPProgressive> {};
+	template<class MATH>
+	struct DeferredInterlace : public Deferred2x1Base<MATH, BPInterlace> {};
+#endif
+
 
 	class CachedTile
 	{
@@ -96,18 +127,8 @@ namespace TileImpl {
 				TileAddr += BG.NameSelect;
 			TileAddr &= 0xffff;
 			TileNumber = TileAddr >> BG.TileShift;
-			if (Tile & H_FLIP)
-			{
-				pCache = &BG.BufferFlip[TileNumber << 6];
-				if (!BG.BufferedFlip[TileNumber])
-					BG.BufferedFlip[TileNumber] = BG.ConvertTileFlip(pCache, TileAddr, Tile & 0x3ff);
-			}
-			else
-			{
-				pCache = &BG.Buffer[TileNumber << 6];
-				if (!BG.Buffered[TileNumber])
-					BG.Buffered[TileNumber] = BG.ConvertTile(pCache, TileAddr, Tile & 0x3ff);
-			}
+			// S9xSelectTileConverter has already converted whatever VRAM writes left stale
+			pCache = &((Tile & H_FLIP) ? BG.BufferFlip : BG.Buffer)[TileNumber << 6];
 		}
 
 		alwaysinline bool IsBlankTile() const
@@ -145,9 +166,43 @@ namespace TileImpl {
 		{
 			return Main;
 		}
+
+		static alwaysinline uint8 Tag()
+		{
+			return 0;
+		}
 	};
 	typedef NOMATH Blend_None;
 
+	// For the deferred plotters: the blend itself is picked when the line is done, from the same registers.
+	struct DEFERMATH
+	{
+		static alwaysinline uint8 Tag()
+		{
+			return GFX.ClipColors ? 2 : 1;
+		}
+	};
+	typedef DEFERMATH Blend_Deferred;
+
+	struct COLOR_ADD_BRIGHTNESS
+	{
+		static alwaysinline uint16 fn(uint16 C1, uint16 C2)
+		{
+			return ((brightness_cap[ (C1 >> RED_SHIFT_BITS)           +  (C2 >> RED_SHIFT_BITS)          ] << RED_SHIFT_BITS)   |
+					(brightness_cap[((C1 >> GREEN_SHIFT_BITS) & 0x1f) + ((C2 >> GREEN_SHIFT_BITS) & 0x1f)] << GREEN_SHIFT_BITS) |
+		// Proper 15->16bit color conversion moves the high bit of green into the low bit.
+		#if GREEN_SHIFT_BITS == 6
+				   ((brightness_cap[((C1 >> 6) & 0x1f) + ((C2 >> 6) & 0x1f)] & 0x10) << 1) |
+		#endif
+					(brightness_cap[ (C1                      & 0x1f) +  (C2                      & 0x1f)]      ));
+		}
+
+		static alwaysinline uint16 fn1_2(uint16 C1, uint16 C2)
+		{
+			return COLOR_ADD::fn1_2(C1, C2);
+		}
+	};
+
 	template<class Op>
 	struct REGMATH
 	{
@@ -214,6 +269,32 @@ namespace TileImpl {
 	};
 	#endif
 
+#ifdef S9X_SIMD
+	template<
+		template<class PIXEL_> class TILE,
+		template<class MATH> class PIXEL
+	>
+	struct DeferredRenderers
+	{
+		enum { Pitch = PIXEL<Blend_None>::Pitch };
+		typedef typename TILE< PIXEL<Blend_None> >::call_t call_t;
+
+		static call_t Functions[2];
+	};
+
+	#ifdef _TILEIMPL_CPP_
+	template<
+		template<class PIXEL_> class TILE,
+		template<class MATH> class PIXEL
+	>
+	typename DeferredRenderers<TILE, PIXEL>::call_t DeferredRenderers<TILE, PIXEL>::Functions[2] =
+	{
+		TILE< PIXEL<Blend_None> >::Draw,
+		TILE< PIXEL<Blend_Deferred> >::Draw,
+	};
+	#endif
+#endif
+
 	// Basic routine to render an unclipped tile.
 	// Input parameters:
 	//     bpstart_t = either StartLine or (StartLine * 2 + BG.InterlaceLine),
@@ -538,7 +619,9 @@ namespace TileImpl {
 
 		static void Draw(uint32 Left, uint32 Right, int D)
 		{
+		#ifndef S9X_SIMD
 			uint8	*VRAM1 = Memory.VRAM + 1;
+		#endif
 
 			if (OP::DCMODE())
 			{
@@ -595,6 +678,18 @@ namespace TileImpl {
 
 				uint8	Pix;
 
+			#ifdef S9X_SIMD
+				uint8	Line7[256];
+
+				S9xFetchMode7Line(Line7, Right - Left, AA, BB, CC, DD, aa, cc);
+
+				for (uint32 x = Left; x < Right; x++)
+				{
+					uint8	b = Line7[x - Left];
+
+					Pix = b & OP::MASK; DRAW_PIXEL(x, Pix);
+				}
+			#else
 				if (!PPU.Mode7Repeat)
 				{
 					for (uint32 x = Left; x < Right; x++, AA += aa, CC += cc)
@@ -631,6 +726,7 @@ namespace TileImpl {
 						Pix = b & OP::MASK; DRAW_PIXEL(x, Pix);
 					}
 				}
+			#endif
 			}
 		}
 	};
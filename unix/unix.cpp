@@ -1902,7 +1902,10 @@ int main (int argc, char **argv)
 			else if(IPPU.TotalEmulatedFrames % unixSettings.rewindGranularity == 0)
 				stateMan.push();
 
-			S9xMainLoop();
+			if (Settings.RunAheadFrames)
+				S9xMainLoopRunAhead();
+			else
+				S9xMainLoop();
 		}
                 if (Settings.Paused && frame_advance)
                 {